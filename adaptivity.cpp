@@ -2,7 +2,244 @@
 
 template <int dim>
 Adaptivity<dim>::Adaptivity(Parameters<dim>& parameters, MPI_Comm& mpi_communicator) :
-  parameters(parameters), mpi_communicator(mpi_communicator)
+  parameters(parameters), mpi_communicator(mpi_communicator), assembly_jumps(0), assembly_areas(0), indicator_jumps(0), indicator_areas(0)
 { }
 
+template <int dim>
+void Adaptivity<dim>::set_assembly_jumps(const std::vector<std::array<double, dim> >* jumps, const std::vector<std::array<double, dim> >* areas)
+{
+  this->assembly_jumps = jumps;
+  this->assembly_areas = areas;
+}
+
+template <int dim>
+Adaptivity<dim>::JumpScratchData::JumpScratchData(const Mapping<dim>& mapping, const FiniteElement<dim>& fe, const Quadrature<dim - 1>& face_quadrature, int quantities, unsigned int n_directions) :
+  fe_v_face(mapping, fe, face_quadrature, update_values | update_JxW_values | ((quantities & jump_curl_B_squared) ? update_gradients : update_default)),
+  fe_v_subface(mapping, fe, face_quadrature, update_values | update_JxW_values | ((quantities & jump_curl_B_squared) ? update_gradients : update_default)),
+  fe_v_face_neighbor(mapping, fe, face_quadrature, update_values | ((quantities & jump_curl_B_squared) ? update_gradients : update_default)),
+  quantities(quantities),
+  n_directions(n_directions)
+{
+}
+
+template <int dim>
+Adaptivity<dim>::JumpScratchData::JumpScratchData(const JumpScratchData& scratch) :
+  fe_v_face(scratch.fe_v_face.get_mapping(), scratch.fe_v_face.get_fe(), scratch.fe_v_face.get_quadrature(), scratch.fe_v_face.get_update_flags()),
+  fe_v_subface(scratch.fe_v_subface.get_mapping(), scratch.fe_v_subface.get_fe(), scratch.fe_v_subface.get_quadrature(), scratch.fe_v_subface.get_update_flags()),
+  fe_v_face_neighbor(scratch.fe_v_face_neighbor.get_mapping(), scratch.fe_v_face_neighbor.get_fe(), scratch.fe_v_face_neighbor.get_quadrature(), scratch.fe_v_face_neighbor.get_update_flags()),
+  quantities(scratch.quantities),
+  n_directions(scratch.n_directions)
+{
+}
+
+template <int dim>
+void Adaptivity<dim>::jump_quantity_values(const FEFaceValuesBase<dim>& fe_v, const TrilinosWrappers::MPI::Vector& solution, JumpScratchData& scratch, std::vector<double>& values) const
+{
+  const unsigned int n_q_points = fe_v.n_quadrature_points;
+  values.clear();
+  scratch.u.resize(n_q_points);
+  if (scratch.quantities & jump_density)
+  {
+    fe_v[FEValuesExtractors::Scalar(0)].get_function_values(solution, scratch.u);
+    values.insert(values.end(), scratch.u.begin(), scratch.u.end());
+  }
+  if (scratch.quantities & jump_energy)
+  {
+    fe_v[FEValuesExtractors::Scalar(4)].get_function_values(solution, scratch.u);
+    values.insert(values.end(), scratch.u.begin(), scratch.u.end());
+  }
+  if (scratch.quantities & jump_curl_B_squared)
+  {
+    scratch.curls.resize(n_q_points);
+    fe_v[FEValuesExtractors::Vector(dim + 2)].get_function_curls(solution, scratch.curls);
+    for (unsigned int q = 0; q < n_q_points; ++q)
+      values.push_back(scratch.curls[q].norm_square());
+  }
+}
+
+template <int dim>
+void Adaptivity<dim>::add_face_jump(const FEFaceValuesBase<dim>& fe_v, const FEFaceValuesBase<dim>& fe_v_neighbor, const TrilinosWrappers::MPI::Vector& solution, const typename DoFHandler<dim>::active_cell_iterator& cell,
+  const typename DoFHandler<dim>::cell_iterator& neighbor, unsigned int direction, JumpScratchData& scratch, JumpCopyData& copy_data) const
+{
+  jump_quantity_values(fe_v, solution, scratch, scratch.values);
+  jump_quantity_values(fe_v_neighbor, solution, scratch, scratch.values_neighbor);
+
+  const std::vector<double> &JxW = fe_v.get_JxW_values();
+  const unsigned int n_q_points = fe_v.n_quadrature_points;
+  FaceJump face_jump = { cell->active_cell_index(), direction, 0., 0. };
+  for (unsigned int q = 0; q < n_q_points; ++q)
+    face_jump.area += JxW[q];
+  for (unsigned int i = 0; i < scratch.values.size(); ++i)
+    face_jump.jump += std::fabs(scratch.values[i] - scratch.values_neighbor[i]) * JxW[i % n_q_points];
+
+  copy_data.face_jumps.push_back(face_jump);
+  if (neighbor->is_locally_owned())
+  {
+    face_jump.cell_index = neighbor->active_cell_index();
+    copy_data.face_jumps.push_back(face_jump);
+  }
+}
+
+template <int dim>
+void Adaptivity<dim>::jump_worker(const typename DoFHandler<dim>::active_cell_iterator& cell, JumpScratchData& scratch, JumpCopyData& copy_data, const TrilinosWrappers::MPI::Vector& solution) const
+{
+  copy_data.face_jumps.clear();
+  for (unsigned int face_no = 0; face_no < GeometryInfo<dim>::faces_per_cell; ++face_no)
+  {
+    const unsigned int direction = face_no / 2;
+    if (direction >= scratch.n_directions)
+      continue;
+    typename DoFHandler<dim>::face_iterator face = cell->face(face_no);
+    if (face->at_boundary())
+      continue;
+
+    Assert(cell->neighbor(face_no).state() == IteratorState::valid, ExcInternalError());
+    typename DoFHandler<dim>::cell_iterator neighbor = cell->neighbor(face_no);
+    if (face->has_children())
+    {
+      // Evaluated from the (finer) neighbor children, unless they belong to another process.
+      unsigned int neighbor2 = cell->neighbor_face_no(face_no);
+      for (unsigned int subface_no = 0; subface_no < face->number_of_children(); ++subface_no)
+      {
+        typename DoFHandler<dim>::cell_iterator neighbor_child = cell->neighbor_child_on_subface(face_no, subface_no);
+        // Refined (anisotropically) parallel to the subface - its child on the subface.
+        while (neighbor_child->has_children())
+          neighbor_child = neighbor_child->child(GeometryInfo<dim>::child_cell_on_face(neighbor_child->refinement_case(), neighbor2, 0));
+        if (neighbor_child->is_locally_owned())
+          continue;
+        scratch.fe_v_subface.reinit(cell, face_no, subface_no);
+        scratch.fe_v_face_neighbor.reinit(neighbor_child, neighbor2);
+        add_face_jump(scratch.fe_v_subface, scratch.fe_v_face_neighbor, solution, cell, neighbor_child, direction, scratch, copy_data);
+      }
+    }
+    else if (cell->neighbor_is_coarser(face_no))
+    {
+      std::pair<unsigned int, unsigned int> neighbor_face_subface = cell->neighbor_of_coarser_neighbor(face_no);
+      Assert(neighbor_face_subface.first < GeometryInfo<dim>::faces_per_cell, ExcInternalError());
+      Assert(neighbor_face_subface.second < neighbor->face(neighbor_face_subface.first)->number_of_children(), ExcInternalError());
+      Assert(neighbor->neighbor_child_on_subface(neighbor_face_subface.first, neighbor_face_subface.second) == cell, ExcInternalError());
+      scratch.fe_v_face.reinit(cell, face_no);
+      scratch.fe_v_subface.reinit(neighbor, neighbor_face_subface.first, neighbor_face_subface.second);
+      add_face_jump(scratch.fe_v_face, scratch.fe_v_subface, solution, cell, neighbor, direction, scratch, copy_data);
+    }
+    else
+    {
+      // A neighbor of the same level may be refined (anisotropically) parallel to the face, then its child on the face is the neighbor.
+      const unsigned int neighbor2 = cell->neighbor_face_no(face_no);
+      while (neighbor->has_children())
+        neighbor = neighbor->child(GeometryInfo<dim>::child_cell_on_face(neighbor->refinement_case(), neighbor2, 0));
+      // Faces between two locally owned cells are evaluated from the one with the lower index.
+      if (neighbor->is_locally_owned() && (neighbor->active_cell_index() < cell->active_cell_index()))
+        continue;
+      scratch.fe_v_face.reinit(cell, face_no);
+      scratch.fe_v_face_neighbor.reinit(neighbor, neighbor2);
+      add_face_jump(scratch.fe_v_face, scratch.fe_v_face_neighbor, solution, cell, neighbor, direction, scratch, copy_data);
+    }
+  }
+}
+
+template <int dim>
+void Adaptivity<dim>::jump_copier(const JumpCopyData& copy_data)
+{
+  for (unsigned int i = 0; i < copy_data.face_jumps.size(); ++i)
+  {
+    const FaceJump& face_jump = copy_data.face_jumps[i];
+    this->cell_jumps[face_jump.cell_index][face_jump.direction] += face_jump.jump;
+    this->cell_areas[face_jump.cell_index][face_jump.direction] += face_jump.area;
+  }
+}
+
+template <int dim>
+void Adaptivity<dim>::calculate_jumps(const TrilinosWrappers::MPI::Vector& solution, const DoFHandler<dim>& dof_handler, const Mapping<dim>& mapping, int quantities, unsigned int n_directions, Vector<double>& indicator)
+{
+  std::array<double, dim> zero;
+  zero.fill(0.);
+  this->cell_jumps.assign(dof_handler.get_triangulation().n_active_cells(), zero);
+  this->cell_areas.assign(dof_handler.get_triangulation().n_active_cells(), zero);
+
+  typedef FilteredIterator<typename DoFHandler<dim>::active_cell_iterator> LocallyOwnedCellIterator;
+  const QGauss<dim - 1> face_quadrature(1);
+  WorkStream::run(LocallyOwnedCellIterator(IteratorFilters::LocallyOwnedCell(), dof_handler.begin_active()), LocallyOwnedCellIterator(IteratorFilters::LocallyOwnedCell(), dof_handler.end()),
+    std::bind(&Adaptivity<dim>::jump_worker, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::cref(solution)),
+    std::bind(&Adaptivity<dim>::jump_copier, this, std::placeholders::_1),
+    JumpScratchData(mapping, dof_handler.get_fe(), face_quadrature, quantities, n_directions), JumpCopyData());
+
+  jump_indicator(dof_handler, this->cell_jumps, this->cell_areas, n_directions, indicator);
+  this->indicator_jumps = &this->cell_jumps;
+  this->indicator_areas = &this->cell_areas;
+}
+
+template <int dim>
+void Adaptivity<dim>::jump_indicator(const DoFHandler<dim>& dof_handler, const std::vector<std::array<double, dim> >& jumps, const std::vector<std::array<double, dim> >& areas, unsigned int n_directions, Vector<double>& indicator) const
+{
+  for (typename DoFHandler<dim>::active_cell_iterator cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
+  {
+    if (!cell->is_locally_owned())
+      continue;
+    const unsigned int index = cell->active_cell_index();
+    double sum_of_average_jumps = 0.;
+    for (unsigned int d = 0; d < n_directions; ++d)
+      if (areas[index][d] > 0.)
+        sum_of_average_jumps += jumps[index][d] / areas[index][d];
+    for (int i = 0; i < this->parameters.volume_factor; i++)
+      sum_of_average_jumps *= cell->diameter();
+    indicator(index) = sum_of_average_jumps;
+  }
+}
+
+template <int dim>
+void Adaptivity<dim>::calculate_indicator(int time_step, const TrilinosWrappers::MPI::Vector& solution, const DoFHandler<dim>& dof_handler, const Mapping<dim>& mapping, int quantities, unsigned int n_directions, Vector<double>& indicator)
+{
+  if ((time_step > 0) && this->assembly_jumps && (this->assembly_jumps->size() == dof_handler.get_triangulation().n_active_cells()))
+  {
+    jump_indicator(dof_handler, *this->assembly_jumps, *this->assembly_areas, n_directions, indicator);
+    this->indicator_jumps = this->assembly_jumps;
+    this->indicator_areas = this->assembly_areas;
+  }
+  else
+    calculate_jumps(solution, dof_handler, mapping, quantities, n_directions, indicator);
+}
+
+template <int dim>
+void Adaptivity<dim>::set_refinement_cases(const DoFHandler<dim>& dof_handler, unsigned int n_directions) const
+{
+  if (!this->parameters.anisotropic_refinement)
+    return;
+#ifdef HAVE_MPI
+  // p4est only supports isotropic refinement.
+  AssertThrow(false, ExcMessage("Anisotropic refinement is not supported with MPI."));
+#endif
+  Assert(this->indicator_jumps && (this->indicator_jumps->size() == dof_handler.get_triangulation().n_active_cells()), ExcInternalError());
+
+  for (typename DoFHandler<dim>::active_cell_iterator cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
+  {
+    if (!cell->is_locally_owned() || !cell->refine_flag_set())
+      continue;
+    const unsigned int index = cell->active_cell_index();
+    std::array<double, dim> average_jumps;
+    double max_average_jump = 0.;
+    for (unsigned int d = 0; d < n_directions; ++d)
+    {
+      average_jumps[d] = ((*this->indicator_areas)[index][d] > 0.) ? (*this->indicator_jumps)[index][d] / (*this->indicator_areas)[index][d] : 0.;
+      max_average_jump = std::max(max_average_jump, average_jumps[d]);
+    }
+    // The direction of the largest jump always qualifies (and all of them do if there are no jumps).
+    RefinementCase<dim> refinement_case = RefinementCase<dim>::no_refinement;
+    for (unsigned int d = 0; d < n_directions; ++d)
+      if (average_jumps[d] >= this->parameters.anisotropic_refinement_threshold * max_average_jump)
+        refinement_case = refinement_case | RefinementCase<dim>::cut_axis(d);
+    cell->set_refine_flag(refinement_case);
+  }
+}
+
+template <int dim>
+void Adaptivity<dim>::keep_initial_cells(Triangulation<dim>& triangulation) const
+{
+  if (this->parameters.coarse_mesh_refinements == 0)
+    return;
+  for (typename Triangulation<dim>::active_cell_iterator cell = triangulation.begin_active(); cell != triangulation.end(); ++cell)
+    if (cell->coarsen_flag_set() && (cell->level() <= (int)this->parameters.coarse_mesh_refinements))
+      cell->clear_coarsen_flag();
+}
+
 template class Adaptivity<3>;
@@ -17,8 +17,86 @@ public:
 #endif
     , const Mapping<dim>& mapping) = 0;
 
+  // Jumps of Parameters::assembly_indicator_components and the face areas per active cell index and direction, accumulated by Problem during assembly.
+  void set_assembly_jumps(const std::vector<std::array<double, dim> >* jumps, const std::vector<std::array<double, dim> >* areas);
+
   protected:
   Parameters<dim>& parameters;
   MPI_Comm& mpi_communicator;
+
+  // Quantities whose jumps over interior faces calculate_jumps() measures (bitmask).
+  enum JumpQuantity
+  {
+    jump_density = 1,
+    jump_energy = 2,
+    jump_curl_B_squared = 4
+  };
+
+  // Jump indicator of all locally owned cells - the sum over the first n_directions directions of the jumps of the quantities integrated over the cell's interior faces
+  // in the direction, divided by the faces' area, times the cell diameter to the power of Parameters::volume_factor.
+  // Cells are processed by multiple threads, and every face is evaluated only once (its jump added to both cells).
+  void calculate_jumps(const TrilinosWrappers::MPI::Vector& solution, const DoFHandler<dim>& dof_handler, const Mapping<dim>& mapping, int quantities, unsigned int n_directions, Vector<double>& indicator);
+
+  // The same indicator from the jumps accumulated during assembly if there are any (not in the first time step, where both sides of all faces are the initial condition),
+  // otherwise calculate_jumps() of the quantities.
+  void calculate_indicator(int time_step, const TrilinosWrappers::MPI::Vector& solution, const DoFHandler<dim>& dof_handler, const Mapping<dim>& mapping, int quantities, unsigned int n_directions, Vector<double>& indicator);
+
+  // With Parameters::anisotropic_refinement, restricts the refinement of the flagged locally owned cells to those of the first n_directions directions
+  // whose average jump (of the last calculated indicator) is at least Parameters::anisotropic_refinement_threshold times the largest one.
+  // To be called between flagging the cells and prepare_coarsening_and_refinement().
+  void set_refinement_cases(const DoFHandler<dim>& dof_handler, unsigned int n_directions) const;
+
+  // Clears the coarsening flags of the cells of the initial mesh (Parameters::coarse_mesh_refinements) - they are refined cells of the coarse mesh,
+  // but are not to be coarsened below the initial resolution. To be called between flagging the cells and prepare_coarsening_and_refinement().
+  void keep_initial_cells(Triangulation<dim>& triangulation) const;
+
+private:
+  struct JumpScratchData
+  {
+    JumpScratchData(const Mapping<dim>& mapping, const FiniteElement<dim>& fe, const Quadrature<dim - 1>& face_quadrature, int quantities, unsigned int n_directions);
+    JumpScratchData(const JumpScratchData& scratch);
+    FEFaceValues<dim> fe_v_face;
+    FESubfaceValues<dim> fe_v_subface;
+    FEFaceValues<dim> fe_v_face_neighbor;
+    const int quantities;
+    const unsigned int n_directions;
+    // Values of the quantities (one after another) on both sides of the face.
+    std::vector<double> values, values_neighbor;
+    std::vector<double> u;
+    std::vector<Tensor<1, dim> > curls;
+  };
+
+  struct FaceJump
+  {
+    unsigned int cell_index;
+    unsigned int direction;
+    double jump;
+    double area;
+  };
+
+  struct JumpCopyData
+  {
+    std::vector<FaceJump> face_jumps;
+  };
+
+  void jump_worker(const typename DoFHandler<dim>::active_cell_iterator& cell, JumpScratchData& scratch, JumpCopyData& copy_data, const TrilinosWrappers::MPI::Vector& solution) const;
+  void jump_copier(const JumpCopyData& copy_data);
+  // Values of the selected quantities in the quadrature points of fe_v.
+  void jump_quantity_values(const FEFaceValuesBase<dim>& fe_v, const TrilinosWrappers::MPI::Vector& solution, JumpScratchData& scratch, std::vector<double>& values) const;
+  // Jump over the face (fe_v on the cell side, fe_v_neighbor on the neighbor side), added to the cell, and to the neighbor if it is locally owned.
+  void add_face_jump(const FEFaceValuesBase<dim>& fe_v, const FEFaceValuesBase<dim>& fe_v_neighbor, const TrilinosWrappers::MPI::Vector& solution, const typename DoFHandler<dim>::active_cell_iterator& cell,
+    const typename DoFHandler<dim>::cell_iterator& neighbor, unsigned int direction, JumpScratchData& scratch, JumpCopyData& copy_data) const;
+
+  // The indicator from the jumps and areas per active cell index and direction.
+  void jump_indicator(const DoFHandler<dim>& dof_handler, const std::vector<std::array<double, dim> >& jumps, const std::vector<std::array<double, dim> >& areas, unsigned int n_directions, Vector<double>& indicator) const;
+
+  // Per active cell index and direction - reused between the calls.
+  std::vector<std::array<double, dim> > cell_jumps, cell_areas;
+  // Set by set_assembly_jumps().
+  const std::vector<std::array<double, dim> >* assembly_jumps;
+  const std::vector<std::array<double, dim> >* assembly_areas;
+  // Jumps and areas the last indicator was calculated from (cell_jumps / cell_areas, or the assembly ones).
+  const std::vector<std::array<double, dim> >* indicator_jumps;
+  const std::vector<std::array<double, dim> >* indicator_areas;
 };
-#endif
\ No newline at end of file
+#endif
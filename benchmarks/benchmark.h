@@ -0,0 +1,70 @@
+#ifndef _BENCHMARK_H
+#define _BENCHMARK_H
+
+#include "util.h"
+
+// Collects named benchmark results (each a list of numeric fields) and writes them as JSON.
+class BenchmarkResults
+{
+public:
+  BenchmarkResults(const std::string& suite) : suite(suite) {};
+
+  // Starts a new result.
+  void add(const std::string& name)
+  {
+    this->names.push_back(name);
+    this->fields.push_back(std::vector<std::pair<std::string, double> >());
+  }
+
+  // Adds a field to the last result.
+  void set(const std::string& field, double value)
+  {
+    this->fields.back().push_back(std::make_pair(field, value));
+  }
+
+  // Human-readable line of the last result.
+  void print_last() const
+  {
+    std::cout << std::left << std::setw(40) << this->names.back() << std::right;
+    for (unsigned int i = 0; i < this->fields.back().size(); ++i)
+      std::cout << "  " << this->fields.back()[i].first << ": " << this->fields.back()[i].second;
+    std::cout << std::endl;
+  }
+
+  void write_json(std::ostream& out) const
+  {
+    out << "{" << std::endl << "  \"suite\": \"" << this->suite << "\"," << std::endl << "  \"results\": [" << std::endl;
+    for (unsigned int i = 0; i < this->names.size(); ++i)
+    {
+      out << "    { \"name\": \"" << this->names[i] << "\"";
+      for (unsigned int j = 0; j < this->fields[i].size(); ++j)
+        out << ", \"" << this->fields[i][j].first << "\": " << std::setprecision(10) << this->fields[i][j].second;
+      out << " }" << (i + 1 < this->names.size() ? "," : "") << std::endl;
+    }
+    out << "  ]" << std::endl << "}" << std::endl;
+  }
+
+private:
+  std::string suite;
+  std::vector<std::string> names;
+  std::vector<std::vector<std::pair<std::string, double> > > fields;
+};
+
+// Wall-clock seconds elapsed since start.
+inline double seconds_since(const std::chrono::steady_clock::time_point& start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Writes the results to the file given as the command-line argument with the index arg (if present), and always to std::cout.
+inline void write_results(const BenchmarkResults& results, int argc, char *argv[], int arg)
+{
+  if (argc > arg)
+  {
+    std::ofstream out(argv[arg]);
+    results.write_json(out);
+  }
+  results.write_json(std::cout);
+}
+
+#endif
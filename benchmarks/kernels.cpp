@@ -0,0 +1,319 @@
+#include "util.h"
+#include "problem.h"
+#include "equationsMhd.h"
+#include "completeEllipticIntegrals.h"
+#include "initialConditionOT.h"
+#include "benchmark.h"
+
+// Microbenchmarks of the hot kernels - numerical fluxes, flux matrix, FE_DG_Taylor evaluation, slope limiters, elliptic integrals.
+// Fails (exit code 1) if the elliptic integrals are not within 1e-14 of the reference values.
+// Usage: benchmark-kernels [output.json]
+
+#define DIMENSION 3
+#define EQUATIONS EquationsTypeMhd
+
+typedef std::array<double, Equations<EQUATIONS, DIMENSION>::n_components> values_vector;
+typedef std::array<float, Equations<EQUATIONS, DIMENSION>::n_components> values_vector_float;
+
+// Admissible states around the Orszag-Tang state, perturbed pseudo-randomly (with a fixed seed).
+void prepare_states(std::vector<values_vector>& states, const Parameters<DIMENSION>& parameters)
+{
+  srand(1);
+  for (unsigned int i = 0; i < states.size(); ++i)
+  {
+    double r[7];
+    for (unsigned int j = 0; j < 7; ++j)
+      r[j] = (double)rand() / RAND_MAX;
+    states[i][0] = (25. / (36. * My_PI)) * (.5 + r[0]);
+    for (unsigned int d = 0; d < DIMENSION; ++d)
+    {
+      states[i][1 + d] = states[i][0] * (r[1 + d] - .5);
+      states[i][5 + d] = (r[4 + d] - .5) / std::sqrt(4. * My_PI);
+    }
+    double pressure = (5. / (12. * My_PI)) * (.5 + r[0] * r[1]);
+    states[i][4] = (pressure / (parameters.gas_gamma - 1.0)) + 0.5 * (states[i][5] * states[i][5] + states[i][6] * states[i][6] + states[i][7] * states[i][7]) +
+      0.5 * (states[i][1] * states[i][1] + states[i][2] * states[i][2] + states[i][3] * states[i][3]) / states[i][0];
+  }
+}
+
+// Number: the precision of the states (Parameters::single_precision_storage).
+template <typename NumFluxType, typename Number>
+void benchmark_numerical_flux(BenchmarkResults& results, const std::string& name, Parameters<DIMENSION>& parameters,
+  const std::vector<std::array<Number, Equations<EQUATIONS, DIMENSION>::n_components> >& states, unsigned int repetitions)
+{
+  NumFluxType num_flux(parameters);
+  std::array<Tensor<1, DIMENSION>, 2 * DIMENSION> normals;
+  for (unsigned int d = 0; d < DIMENSION; ++d)
+  {
+    normals[2 * d][d] = -1.;
+    normals[2 * d + 1][d] = 1.;
+  }
+
+  std::array<Number, Equations<EQUATIONS, DIMENSION>::n_components> normal_flux;
+  double max_speed = 0., sink = 0.;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned int repetition = 0; repetition < repetitions; ++repetition)
+    for (unsigned int i = 0; i < states.size(); ++i)
+    {
+      num_flux.numerical_normal_flux(normals[i % (2 * DIMENSION)], states[i], states[(i + 1) % states.size()], normal_flux, max_speed);
+      sink += normal_flux[0];
+    }
+  double elapsed = seconds_since(start);
+
+  results.add(name);
+  results.set("evaluations", (double)repetitions * states.size());
+  results.set("ns_per_evaluation", 1.e9 * elapsed / ((double)repetitions * states.size()));
+  results.set("checksum", sink + max_speed);
+  results.print_last();
+}
+
+template <typename Number>
+void benchmark_flux_matrix(BenchmarkResults& results, const std::string& name, const Parameters<DIMENSION>& parameters,
+  const std::vector<std::array<Number, Equations<EQUATIONS, DIMENSION>::n_components> >& states, unsigned int repetitions)
+{
+  std::array<std::array<Number, DIMENSION>, Equations<EQUATIONS, DIMENSION>::n_components> flux;
+  double sink = 0.;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned int repetition = 0; repetition < repetitions; ++repetition)
+    for (unsigned int i = 0; i < states.size(); ++i)
+    {
+      Equations<EQUATIONS, DIMENSION>::compute_flux_matrix(states[i], flux, parameters);
+      sink += flux[0][0];
+    }
+  double elapsed = seconds_since(start);
+
+  results.add(name);
+  results.set("evaluations", (double)repetitions * states.size());
+  results.set("ns_per_evaluation", 1.e9 * elapsed / ((double)repetitions * states.size()));
+  results.set("checksum", sink);
+  results.print_last();
+}
+
+void benchmark_fe_taylor(BenchmarkResults& results, unsigned int polynomial_order, unsigned int quadrature_order, unsigned int repetitions)
+{
+  Triangulation<DIMENSION> triangulation;
+  GridGenerator::subdivided_hyper_rectangle(triangulation, { 16, 16, 16 }, Point<DIMENSION>(0., 0., 0.), Point<DIMENSION>(1., 1., 1.));
+  const FESystem<DIMENSION> fe(FE_DG_Taylor<DIMENSION>(polynomial_order), Equations<EQUATIONS, DIMENSION>::n_components);
+  DoFHandler<DIMENSION> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+  const MappingQ1<DIMENSION> mapping;
+  const QGauss<DIMENSION> quadrature(quadrature_order);
+  FEValues<DIMENSION> fe_values(mapping, fe, quadrature, update_values | update_JxW_values | update_gradients);
+
+  double sink = 0.;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned int repetition = 0; repetition < repetitions; ++repetition)
+    for (typename DoFHandler<DIMENSION>::active_cell_iterator cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
+    {
+      fe_values.reinit(cell);
+      sink += fe_values.shape_value(0, 0);
+    }
+  double elapsed = seconds_since(start);
+
+  results.add("FE_DG_Taylor::fill_fe_values P" + Utilities::int_to_string(polynomial_order) + " Q" + Utilities::int_to_string(quadrature_order));
+  results.set("cells", (double)repetitions * triangulation.n_active_cells());
+  results.set("ns_per_cell", 1.e9 * elapsed / ((double)repetitions * triangulation.n_active_cells()));
+  results.set("checksum", sink);
+  results.print_last();
+}
+
+void benchmark_slope_limiters(BenchmarkResults& results, MPI_Comm& mpi_communicator, unsigned int repetitions)
+{
+  Parameters<DIMENSION> parameters;
+  parameters.corner_a = Point<DIMENSION>(0., 0., 0.);
+  parameters.corner_b = Point<DIMENSION>(1., 1., 0.01);
+  parameters.refinements = { 64, 64, 1 };
+  parameters.periodic_boundaries = { { 0, 1, 0 },{ 2, 3, 1 } };
+  parameters.use_div_free_space_for_B = false;
+  parameters.num_flux_type = Parameters<DIMENSION>::hlld;
+  parameters.cfl_coefficient = .05;
+  parameters.quadrature_order = 3;
+  parameters.polynomial_order_dg = 1;
+  parameters.patches = 0;
+  parameters.final_time = 1.;
+  parameters.output_step = -1.;
+  parameters.output_file_prefix = "benchmark-kernels";
+  // One time step provides a non-trivial (unlimited) solution.
+  parameters.limit = false;
+  parameters.max_time_steps = 1;
+
+#ifdef HAVE_MPI
+  parallel::distributed::Triangulation<DIMENSION> triangulation(mpi_communicator);
+#else
+  Triangulation<DIMENSION> triangulation;
+#endif
+  parameters.coarse_mesh_refinements = create_box(triangulation, parameters.refinements, parameters.corner_a, parameters.corner_b, parameters.periodic_boundaries);
+
+  InitialConditionOT<EQUATIONS, DIMENSION> initial_condition(parameters);
+  BoundaryCondition<EQUATIONS, DIMENSION> boundary_conditions(parameters);
+  Equations<EQUATIONS, DIMENSION> equations;
+  Problem<EQUATIONS, DIMENSION> problem(parameters, equations, triangulation, initial_condition, boundary_conditions);
+  problem.run();
+
+  for (int limiter = 0; limiter < 2; ++limiter)
+  {
+    SlopeLimiter<EQUATIONS, DIMENSION>* slope_limiter;
+    if (limiter == 0)
+      slope_limiter = new VertexBasedSlopeLimiter<EQUATIONS, DIMENSION>(parameters, problem.mapping, problem.fe, problem.dof_handler, problem.dofs_per_cell, triangulation, problem.dof_indices, problem.component_ii, problem.is_primitive);
+    else
+      slope_limiter = new BarthJespersenSlopeLimiter<EQUATIONS, DIMENSION>(parameters, problem.mapping, problem.fe, problem.dof_handler, problem.dofs_per_cell, triangulation, problem.dof_indices, problem.component_ii, problem.is_primitive);
+
+    // The first pass fills the limiter cache, it is timed separately.
+    double elapsed_first = 0., elapsed = 0.;
+    for (unsigned int repetition = 0; repetition <= repetitions; ++repetition)
+    {
+      problem.current_limited_solution = problem.current_unlimited_solution;
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      slope_limiter->postprocess(problem.current_limited_solution, problem.current_unlimited_solution);
+      (repetition == 0 ? elapsed_first : elapsed) += seconds_since(start);
+    }
+    delete slope_limiter;
+    // The slowest process determines the throughput.
+    elapsed_first = Utilities::MPI::max(elapsed_first, mpi_communicator);
+    elapsed = Utilities::MPI::max(elapsed, mpi_communicator);
+
+    results.add(limiter == 0 ? "VertexBasedSlopeLimiter::postprocess" : "BarthJespersenSlopeLimiter::postprocess");
+    results.set("cells", (double)triangulation.n_global_active_cells());
+    results.set("ns_per_cell_first_pass", 1.e9 * elapsed_first / triangulation.n_global_active_cells());
+    results.set("ns_per_cell", 1.e9 * elapsed / ((double)repetitions * triangulation.n_global_active_cells()));
+    results.set("cells_per_second", (double)repetitions * triangulation.n_global_active_cells() / elapsed);
+    results.print_last();
+  }
+}
+
+// Reference values K(k), E(k), evaluated by the AGM in 60-digit arithmetic (at the double nearest to k).
+static const double elliptic_integrals_reference[12][3] = {
+  { 0., 1.5707963267948966192, 1.5707963267948966192 },
+  { 0.1, 1.5747455615173559531, 1.5668619420216682908 },
+  { 0.25, 1.5962422221317835101, 1.5459572561054650350 },
+  { 0.5, 1.6857503548125960429, 1.4674622093394271555 },
+  { 0.6, 1.7507538029157525118, 1.4180833944487242439 },
+  { 0.7071067811865476, 1.8540746773013719763, 1.3506438810476754681 },
+  { 0.8, 1.9953027776647294737, 1.2763499431699063834 },
+  { 0.9, 2.2805491384227703005, 1.1716970527816141138 },
+  { 0.99, 3.3566005233611919425, 1.0284758090288040219 },
+  { 0.999, 4.4955963958421437279, 1.0039944099655078208 },
+  { 0.999999, 7.9474797735479670327, 1.0000074474777243921 },
+  { 0.999999999999, 14.855242389793774712, 1.0000000000143549248 } };
+
+// Returns whether the batched version is within 1e-14 (relative) of the reference values.
+bool benchmark_elliptic_integrals(BenchmarkResults& results, unsigned int evaluations)
+{
+  std::vector<double> k(evaluations), K(evaluations), E(evaluations);
+  for (unsigned int i = 0; i < evaluations; ++i)
+    k[i] = (i + .5) / evaluations;
+
+  double K_agm, E_agm, sink = 0.;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < evaluations; ++i)
+  {
+    Complete_Elliptic_Integrals_Modulus_AGM(k[i], K_agm, E_agm);
+    sink += K_agm + E_agm;
+  }
+  double elapsed_agm = seconds_since(start);
+
+  start = std::chrono::steady_clock::now();
+  Complete_Elliptic_Integrals_Modulus(k.data(), K.data(), E.data(), evaluations);
+  double elapsed = seconds_since(start);
+
+  // Maximum relative deviation from the AGM.
+  double deviation = 0.;
+  for (unsigned int i = 0; i < evaluations; ++i)
+  {
+    Complete_Elliptic_Integrals_Modulus_AGM(k[i], K_agm, E_agm);
+    deviation = std::max(deviation, std::max(std::abs(K[i] - K_agm) / K_agm, std::abs(E[i] - E_agm) / E_agm));
+  }
+
+  results.add("Complete_Elliptic_Integrals_Modulus_AGM");
+  results.set("evaluations", (double)evaluations);
+  results.set("ns_per_evaluation", 1.e9 * elapsed_agm / evaluations);
+  results.set("checksum", sink);
+  results.print_last();
+
+  // Maximum relative error with respect to the reference values.
+  double error = 0.;
+  for (unsigned int i = 0; i < 12; ++i)
+  {
+    double K_i, E_i;
+    Complete_Elliptic_Integrals_Modulus(&elliptic_integrals_reference[i][0], &K_i, &E_i, 1);
+    error = std::max(error, std::max(std::abs(K_i - elliptic_integrals_reference[i][1]) / elliptic_integrals_reference[i][1],
+      std::abs(E_i - elliptic_integrals_reference[i][2]) / elliptic_integrals_reference[i][2]));
+  }
+
+  results.add("Complete_Elliptic_Integrals_Modulus (batched)");
+  results.set("evaluations", (double)evaluations);
+  results.set("ns_per_evaluation", 1.e9 * elapsed / evaluations);
+  results.set("max_relative_deviation", deviation);
+  results.set("max_relative_error", error);
+  results.print_last();
+  if (error > 1e-14)
+    std::cerr << "Complete_Elliptic_Integrals_Modulus: the relative error " << error << " exceeds 1e-14" << std::endl;
+  return error <= 1e-14;
+}
+
+int main(int argc, char *argv[])
+{
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, 1);
+  MPI_Comm mpi_communicator(MPI_COMM_WORLD);
+
+  try
+  {
+    BenchmarkResults results("kernels");
+    bool passed = true;
+
+    Parameters<DIMENSION> parameters;
+    std::vector<values_vector> states(4096);
+    prepare_states(states, parameters);
+    std::vector<values_vector_float> states_float(states.size());
+    for (unsigned int i = 0; i < states.size(); ++i)
+      for (unsigned int c = 0; c < Equations<EQUATIONS, DIMENSION>::n_components; ++c)
+        states_float[i][c] = states[i][c];
+
+    // Purely local kernels are run on the first process only.
+    if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+    {
+      benchmark_numerical_flux<NumFluxHLLD<EQUATIONS, DIMENSION> >(results, "NumFluxHLLD::numerical_normal_flux", parameters, states, 250);
+      benchmark_numerical_flux<NumFluxLaxFriedrich<EQUATIONS, DIMENSION> >(results, "NumFluxLaxFriedrich::numerical_normal_flux", parameters, states, 250);
+      benchmark_numerical_flux<NumFluxHLLD<EQUATIONS, DIMENSION> >(results, "NumFluxHLLD::numerical_normal_flux (float)", parameters, states_float, 250);
+      benchmark_numerical_flux<NumFluxLaxFriedrich<EQUATIONS, DIMENSION> >(results, "NumFluxLaxFriedrich::numerical_normal_flux (float)", parameters, states_float, 250);
+      benchmark_flux_matrix(results, "compute_flux_matrix", parameters, states, 250);
+      benchmark_flux_matrix(results, "compute_flux_matrix (float)", parameters, states_float, 250);
+      benchmark_fe_taylor(results, 0, 1, 20);
+      benchmark_fe_taylor(results, 1, 3, 20);
+      benchmark_fe_taylor(results, 1, 5, 5);
+      passed = benchmark_elliptic_integrals(results, 1000000);
+    }
+
+    benchmark_slope_limiters(results, mpi_communicator, 10);
+
+    if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+      write_results(results, argc, argv, 1);
+    if (!passed)
+      return 1;
+  }
+  catch (std::exception &exc)
+  {
+    std::cerr << std::endl << std::endl
+      << "----------------------------------------------------"
+      << std::endl;
+    std::cerr << "Exception on processing: " << std::endl
+      << exc.what() << std::endl
+      << "Aborting!" << std::endl
+      << "----------------------------------------------------"
+      << std::endl;
+    return 1;
+  }
+  catch (...)
+  {
+    std::cerr << std::endl << std::endl
+      << "----------------------------------------------------"
+      << std::endl;
+    std::cerr << "Unknown exception!" << std::endl
+      << "Aborting!" << std::endl
+      << "----------------------------------------------------"
+      << std::endl;
+    return 1;
+  };
+
+  return 0;
+}
@@ -0,0 +1,131 @@
+#include "util.h"
+#include "problem.h"
+#include "equationsMhd.h"
+#include "initialConditionOT.h"
+#include "initialConditionMhdBlast.h"
+#include "benchmark.h"
+
+// Validation of Parameters::single_precision_storage - the Orszag-Tang and MHD blast examples run a number of time steps in double precision,
+// and in single precision until the same final time (the CFL steps of both differ), the results are the relative l2-difference of the
+// solutions and the times of both. Fails (exit code 1) if the difference exceeds the tolerance.
+// Usage: benchmark-precision [time steps] [tolerance] [output.json]
+
+#define DIMENSION 3
+#define EQUATIONS EquationsTypeMhd
+
+#include "setups.h"
+
+// Runs the example, returns the elapsed seconds, the final solution and time.
+template <template <EquationsType, int> class InitialConditionType>
+double run_example(MPI_Comm& mpi_communicator, const std::string& name, void(*set_parameters)(Parameters<DIMENSION>&, unsigned int), unsigned int n, int time_steps,
+  double final_time, bool single_precision_storage, TrilinosWrappers::MPI::Vector& solution, double& time)
+{
+  Parameters<DIMENSION> parameters;
+  set_parameters(parameters, n);
+  parameters.output_file_prefix = "benchmark-precision-" + name;
+  parameters.max_time_steps = time_steps;
+  if (final_time > 0.)
+    parameters.final_time = final_time;
+  parameters.single_precision_storage = single_precision_storage;
+
+#ifdef HAVE_MPI
+  parallel::distributed::Triangulation<DIMENSION> triangulation(mpi_communicator);
+#else
+  Triangulation<DIMENSION> triangulation;
+#endif
+  set_triangulation(triangulation, parameters);
+
+  InitialConditionType<EQUATIONS, DIMENSION> initial_condition(parameters);
+  BoundaryCondition<EQUATIONS, DIMENSION> boundary_conditions(parameters);
+  Equations<EQUATIONS, DIMENSION> equations;
+  Problem<EQUATIONS, DIMENSION> problem(parameters, equations, triangulation, initial_condition, boundary_conditions);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  problem.run();
+  double elapsed = Utilities::MPI::max(seconds_since(start), mpi_communicator);
+
+  solution = problem.current_limited_solution;
+  time = problem.time;
+  return elapsed;
+}
+
+// Returns whether the relative l2-difference is within the tolerance.
+template <template <EquationsType, int> class InitialConditionType>
+bool validate_precision(BenchmarkResults& results, MPI_Comm& mpi_communicator, const std::string& name, void(*set_parameters)(Parameters<DIMENSION>&, unsigned int), unsigned int n,
+  int time_steps, double tolerance)
+{
+  // Without adaptivity, both runs have the same mesh and partitioning, hence the same layout of the solution.
+  TrilinosWrappers::MPI::Vector double_solution, single_solution;
+  double double_time, single_time;
+  const double double_seconds = run_example<InitialConditionType>(mpi_communicator, name, set_parameters, n, time_steps, -1., false, double_solution, double_time);
+  // The single precision run ends at the final time of the double precision one (its last step is shortened) - the number of steps is only a safeguard.
+  const double single_seconds = run_example<InitialConditionType>(mpi_communicator, name, set_parameters, n, 2 * time_steps, double_time, true, single_solution, single_time);
+  AssertThrow(single_time == double_time, ExcMessage(name + ": the single precision run did not reach the final time of the double precision run."));
+
+  const double norm = double_solution.l2_norm();
+  single_solution -= double_solution;
+  const double relative_l2_difference = single_solution.l2_norm() / norm;
+
+  results.add(name + " " + Utilities::int_to_string(n));
+  results.set("time_steps", time_steps);
+  results.set("relative_l2_difference", relative_l2_difference);
+  results.set("tolerance", tolerance);
+  results.set("double_time", double_time);
+  results.set("single_time", single_time);
+  results.set("double_seconds", double_seconds);
+  results.set("single_seconds", single_seconds);
+  if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+  {
+    results.print_last();
+    if (relative_l2_difference > tolerance)
+      std::cerr << name << ": the relative l2-difference " << relative_l2_difference << " exceeds the tolerance " << tolerance << std::endl;
+  }
+  return relative_l2_difference <= tolerance;
+}
+
+int main(int argc, char *argv[])
+{
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, dealii::numbers::invalid_unsigned_int);
+  MPI_Comm mpi_communicator(MPI_COMM_WORLD);
+
+  try
+  {
+    const int time_steps = (argc > 1 ? atoi(argv[1]) : 10);
+    // Single precision rounding (~6e-8) of the stored solution and of the kernels, accumulated over the time steps.
+    const double tolerance = (argc > 2 ? atof(argv[2]) : 1e-4);
+    BenchmarkResults results("precision");
+
+    bool passed = validate_precision<InitialConditionOT>(results, mpi_communicator, "orszag-tang", set_parameters_orszag_tang, 64, time_steps, tolerance);
+    passed = validate_precision<InitialConditionMhdBlast>(results, mpi_communicator, "mhd-blast", set_parameters_mhd_blast, 64, time_steps, tolerance) && passed;
+
+    if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+      write_results(results, argc, argv, 3);
+    if (!passed)
+      return 1;
+  }
+  catch (std::exception &exc)
+  {
+    std::cerr << std::endl << std::endl
+      << "----------------------------------------------------"
+      << std::endl;
+    std::cerr << "Exception on processing: " << std::endl
+      << exc.what() << std::endl
+      << "Aborting!" << std::endl
+      << "----------------------------------------------------"
+      << std::endl;
+    return 1;
+  }
+  catch (...)
+  {
+    std::cerr << std::endl << std::endl
+      << "----------------------------------------------------"
+      << std::endl;
+    std::cerr << "Unknown exception!" << std::endl
+      << "Aborting!" << std::endl
+      << "----------------------------------------------------"
+      << std::endl;
+    return 1;
+  };
+
+  return 0;
+}
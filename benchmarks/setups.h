@@ -0,0 +1,58 @@
+#ifndef _BENCHMARK_SETUPS_H
+#define _BENCHMARK_SETUPS_H
+
+// Meshes and parameters of the examples the benchmarks run (DIMENSION has to be defined before inclusion).
+
+#ifdef HAVE_MPI
+inline void set_triangulation(parallel::distributed::Triangulation<DIMENSION>& triangulation, Parameters<DIMENSION>& parameters)
+#else
+inline void set_triangulation(Triangulation<DIMENSION>& triangulation, Parameters<DIMENSION>& parameters)
+#endif
+{
+  parameters.coarse_mesh_refinements = create_box(triangulation, parameters.refinements, parameters.corner_a, parameters.corner_b, parameters.periodic_boundaries);
+}
+
+// The same setup as in examples/orszag-tang.
+inline void set_parameters_orszag_tang(Parameters<DIMENSION>& parameters, unsigned int n)
+{
+  parameters.slope_limiter = parameters.vertexBased;
+  parameters.corner_a = Point<DIMENSION>(0., 0., 0.);
+  parameters.corner_b = Point<DIMENSION>(1., 1., 0.001);
+  parameters.refinements = { n, n, 1 };
+  parameters.limit = false;
+  parameters.use_div_free_space_for_B = true;
+  parameters.periodic_boundaries = { { 0, 1, 0 },{ 2, 3, 1 } };
+  parameters.num_flux_type = Parameters<DIMENSION>::hlld;
+  parameters.lax_friedrich_stabilization_value = 0.5;
+  parameters.cfl_coefficient = .05;
+  parameters.start_limiting_at = .05;
+  parameters.quadrature_order = 5;
+  parameters.polynomial_order_dg = 1;
+  parameters.patches = 0;
+  parameters.output_step = 1.e-2;
+  parameters.final_time = .5;
+}
+
+// The same setup as in examples/mhd-blast (without adaptivity).
+inline void set_parameters_mhd_blast(Parameters<DIMENSION>& parameters, unsigned int n)
+{
+  parameters.corner_a = Point<DIMENSION>(-0.5, -0.75, 0.);
+  parameters.corner_b = Point<DIMENSION>(0.5, 0.75, 1. / 50.);
+  parameters.refinements = { n, (3 * n) / 2, 1 };
+  parameters.limit = true;
+  parameters.limitB = false;
+  parameters.limit_edges_and_vertices = true;
+  parameters.slope_limiter = parameters.vertexBased;
+  parameters.use_div_free_space_for_B = false;
+  parameters.periodic_boundaries = { { 0, 1, 0 },{ 2, 3, 1 } };
+  parameters.num_flux_type = Parameters<DIMENSION>::hlld;
+  parameters.lax_friedrich_stabilization_value = 0.75;
+  parameters.cfl_coefficient = .05;
+  parameters.quadrature_order = 5;
+  parameters.polynomial_order_dg = 1;
+  parameters.patches = 0;
+  parameters.output_step = -1.e-2;
+  parameters.final_time = .5;
+}
+
+#endif
@@ -0,0 +1,103 @@
+#include "util.h"
+#include "problem.h"
+#include "equationsMhd.h"
+#include "initialConditionOT.h"
+#include "initialConditionMhdBlast.h"
+#include "benchmark.h"
+
+// Throughput of full time steps of the Orszag-Tang and MHD blast examples at several mesh sizes.
+// seconds is the whole run, step_seconds (which the throughput is computed from) only the time steps - without the setup, the initial condition and the output.
+// Usage: benchmark-steps [time steps] [output.json]
+
+#define DIMENSION 3
+#define EQUATIONS EquationsTypeMhd
+
+#include "setups.h"
+
+template <template <EquationsType, int> class InitialConditionType>
+void benchmark_steps(BenchmarkResults& results, MPI_Comm& mpi_communicator, const std::string& name, void(*set_parameters)(Parameters<DIMENSION>&, unsigned int), unsigned int n, int time_steps)
+{
+  Parameters<DIMENSION> parameters;
+  set_parameters(parameters, n);
+  parameters.output_file_prefix = "benchmark-" + name;
+  parameters.max_time_steps = time_steps;
+  // The stage timers separate the time steps from the setup, the initial condition and the output.
+  parameters.timing = true;
+
+#ifdef HAVE_MPI
+  parallel::distributed::Triangulation<DIMENSION> triangulation(mpi_communicator);
+#else
+  Triangulation<DIMENSION> triangulation;
+#endif
+  set_triangulation(triangulation, parameters);
+
+  InitialConditionType<EQUATIONS, DIMENSION> initial_condition(parameters);
+  BoundaryCondition<EQUATIONS, DIMENSION> boundary_conditions(parameters);
+  Equations<EQUATIONS, DIMENSION> equations;
+  Problem<EQUATIONS, DIMENSION> problem(parameters, equations, triangulation, initial_condition, boundary_conditions);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  problem.run();
+  // The slowest process determines the throughput.
+  const double elapsed = Utilities::MPI::max(seconds_since(start), mpi_communicator);
+  const double step_seconds = Utilities::MPI::max(problem.timing.time_step_seconds(), mpi_communicator);
+
+  const double cells = triangulation.n_global_active_cells(), dofs = problem.dof_handler.n_dofs();
+  results.add(name + " " + Utilities::int_to_string(parameters.refinements[0]) + "x" + Utilities::int_to_string(parameters.refinements[1]) + "x" + Utilities::int_to_string(parameters.refinements[2]));
+  results.set("processes", Utilities::MPI::n_mpi_processes(mpi_communicator));
+  results.set("cells", cells);
+  results.set("dofs", dofs);
+  results.set("time_steps", problem.time_step_number);
+  results.set("seconds", elapsed);
+  results.set("step_seconds", step_seconds);
+  results.set("cells_per_second", cells * problem.time_step_number / step_seconds);
+  results.set("dofs_per_second", dofs * problem.time_step_number / step_seconds);
+  if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+    results.print_last();
+}
+
+int main(int argc, char *argv[])
+{
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, dealii::numbers::invalid_unsigned_int);
+  MPI_Comm mpi_communicator(MPI_COMM_WORLD);
+
+  try
+  {
+    const int time_steps = (argc > 1 ? atoi(argv[1]) : 10);
+    BenchmarkResults results("steps");
+
+    const unsigned int sizes[] = { 32, 64, 128 };
+    for (unsigned int i = 0; i < 3; ++i)
+      benchmark_steps<InitialConditionOT>(results, mpi_communicator, "orszag-tang", set_parameters_orszag_tang, sizes[i], time_steps);
+    for (unsigned int i = 0; i < 3; ++i)
+      benchmark_steps<InitialConditionMhdBlast>(results, mpi_communicator, "mhd-blast", set_parameters_mhd_blast, sizes[i], time_steps);
+
+    if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+      write_results(results, argc, argv, 2);
+  }
+  catch (std::exception &exc)
+  {
+    std::cerr << std::endl << std::endl
+      << "----------------------------------------------------"
+      << std::endl;
+    std::cerr << "Exception on processing: " << std::endl
+      << exc.what() << std::endl
+      << "Aborting!" << std::endl
+      << "----------------------------------------------------"
+      << std::endl;
+    return 1;
+  }
+  catch (...)
+  {
+    std::cerr << std::endl << std::endl
+      << "----------------------------------------------------"
+      << std::endl;
+    std::cerr << "Unknown exception!" << std::endl
+      << "Aborting!" << std::endl
+      << "----------------------------------------------------"
+      << std::endl;
+    return 1;
+  };
+
+  return 0;
+}
@@ -4,6 +4,13 @@
 template<>
 BoundaryCondition<EquationsTypeMhd, 3>::BoundaryCondition(Parameters<3>& parameters) : parameters(parameters) {};
 
+template <EquationsType equationsType, int dim>
+int BoundaryCondition<equationsType, dim>::dependencies(int boundary_no) const
+{
+  // The default values are the interior state (see bc_vector_value()).
+  return depends_on_state;
+}
+
 template <EquationsType equationsType, int dim>
 void BoundaryCondition<equationsType, dim>::bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, 
   values_vector &result, const grad_vector &grads, const values_vector &W_plus, double time, typename DoFHandler<dim>::active_cell_iterator&) const
@@ -12,4 +19,12 @@ void BoundaryCondition<equationsType, dim>::bc_vector_value(int boundary_no, con
     result[di] = W_plus[di];
 }
 
+template <EquationsType equationsType, int dim>
+void BoundaryCondition<equationsType, dim>::bc_vector_values(int boundary_no, const std::vector<Point<dim> > &points, const std::vector<Tensor<1, dim> > &normals,
+  std::vector<values_vector> &results, const std::vector<grad_vector> &grads, const std::vector<values_vector> &W_plus, double time, typename DoFHandler<dim>::active_cell_iterator& cell) const
+{
+  for (unsigned int q = 0; q < points.size(); ++q)
+    this->bc_vector_value(boundary_no, points[q], normals[q], results[q], grads[q], W_plus[q], time, cell);
+}
+
 template class BoundaryCondition<EquationsTypeMhd, 3>;
@@ -15,10 +15,28 @@ public:
 
   BoundaryCondition(Parameters<dim>& parameters);
 
+  // What the values on a boundary depend on (bitmask returned by dependencies()).
+  enum Dependency
+  {
+    depends_on_time = 1,
+    depends_on_state = 2,
+    depends_on_gradients = 4
+  };
+
+  // Dependencies of the values for this boundary identifier.
+  // Problem only evaluates the interior gradients if some boundary depends on them, and evaluates the boundary values of faces whose values depend on nothing only once (until refinement).
+  // The default is the state (of the default values), implementations that override bc_vector_value() override this as well.
+  virtual int dependencies(int boundary_no) const;
+
   // Values for this boundary identifier.
   virtual void bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, values_vector &result,
     const grad_vector &grads, const values_vector &W_plus, double time, typename DoFHandler<dim>::active_cell_iterator&) const;
 
+  // Values in all quadrature points of a boundary face - this is what Problem calls, once per face.
+  // The default calls bc_vector_value() point by point, implementations override it to do per-face precomputations once, or to evaluate the points in a batch.
+  virtual void bc_vector_values(int boundary_no, const std::vector<Point<dim> > &points, const std::vector<Tensor<1, dim> > &normals, std::vector<values_vector> &results,
+    const std::vector<grad_vector> &grads, const std::vector<values_vector> &W_plus, double time, typename DoFHandler<dim>::active_cell_iterator&) const;
+
   // Passed as a constructor parameter
   Parameters<dim>& parameters;
 };
@@ -0,0 +1,68 @@
+#include "cellwiseSolution.h"
+
+template <int dim, typename Number>
+CellwiseSolution<dim, Number>::CellwiseSolution() : dofs_per_cell(0)
+{
+}
+
+template <int dim, typename Number>
+void CellwiseSolution<dim, Number>::reinit(const DoFHandler<dim>& dof_handler)
+{
+  const FiniteElement<dim>& fe = dof_handler.get_fe();
+  this->dofs_per_cell = fe.dofs_per_cell;
+
+  // Cell layout - sorted by component (the non-primitive ones last), stable within a component.
+  std::vector<std::pair<unsigned int, unsigned int> > component_and_dof(this->dofs_per_cell);
+  for (unsigned int i = 0; i < this->dofs_per_cell; ++i)
+    component_and_dof[i] = std::make_pair(fe.is_primitive(i) ? fe.system_to_component_index(i).first : fe.n_components(), i);
+  std::stable_sort(component_and_dof.begin(), component_and_dof.end());
+  this->positions.resize(this->dofs_per_cell);
+  this->dofs.resize(this->dofs_per_cell);
+  this->block_starts.assign(fe.n_components() + 2, this->dofs_per_cell);
+  for (unsigned int position = this->dofs_per_cell; position-- > 0;)
+  {
+    this->positions[component_and_dof[position].second] = position;
+    this->dofs[position] = component_and_dof[position].second;
+    this->block_starts[component_and_dof[position].first] = position;
+  }
+  // Empty blocks start where the next one does.
+  for (unsigned int c = fe.n_components() + 1; c-- > 0;)
+    this->block_starts[c] = std::min(this->block_starts[c], this->block_starts[c + 1]);
+
+  const unsigned int n_cells = dof_handler.get_triangulation().n_active_cells();
+  this->values.resize(0);
+  this->values.resize(n_cells * this->dofs_per_cell);
+  this->local_indices.clear();
+  this->global_indices.assign(n_cells * this->dofs_per_cell, numbers::invalid_dof_index);
+  std::vector<types::global_dof_index> dof_indices(this->dofs_per_cell);
+  for (typename DoFHandler<dim>::active_cell_iterator cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
+  {
+    if (cell->is_artificial())
+      continue;
+    cell->get_dof_indices(dof_indices);
+    for (unsigned int i = 0; i < this->dofs_per_cell; ++i)
+      this->global_indices[cell->active_cell_index() * this->dofs_per_cell + this->positions[i]] = dof_indices[i];
+  }
+}
+
+template <int dim, typename Number>
+void CellwiseSolution<dim, Number>::gather(const TrilinosWrappers::MPI::Vector& vector)
+{
+  if (this->local_indices.empty())
+  {
+    const Epetra_BlockMap& map = vector.trilinos_vector().Map();
+    this->local_indices.resize(this->global_indices.size());
+    for (unsigned int k = 0; k < this->global_indices.size(); ++k)
+      this->local_indices[k] = (this->global_indices[k] == numbers::invalid_dof_index) ? -1 : map.LID(static_cast<TrilinosWrappers::types::int_type>(this->global_indices[k]));
+    std::vector<types::global_dof_index>().swap(this->global_indices);
+  }
+
+  const double* vector_values = vector.trilinos_vector()[0];
+  const unsigned int n = this->local_indices.size();
+  for (unsigned int k = 0; k < n; ++k)
+    if (this->local_indices[k] >= 0)
+      this->values[k] = static_cast<Number>(vector_values[this->local_indices[k]]);
+}
+
+template class CellwiseSolution<3, double>;
+template class CellwiseSolution<3, float>;
@@ -0,0 +1,59 @@
+#ifndef _CELLWISE_SOLUTION_H
+#define _CELLWISE_SOLUTION_H
+
+#include "util.h"
+#include <deal.II/base/aligned_vector.h>
+
+// Copy of a (ghosted) solution vector laid out per active cell as [component][basis function], in one contiguous aligned array -
+// the per-cell kernels read a contiguous block instead of looking up every global index in the Trilinos vector.
+// Within a cell, the primitive degrees of freedom come component by component (in the order of the base element), the non-primitive ones
+// (of the div-free space) after them.
+// Number is the type of the stored values (float halves the memory traffic of the kernels, which still compute in double).
+template <int dim, typename Number = double>
+class CellwiseSolution
+{
+public:
+  CellwiseSolution();
+
+  // Layout of the locally owned and ghost cells of the dof handler (after distribute_dofs()).
+  void reinit(const DoFHandler<dim>& dof_handler);
+
+  // Copies the values of the locally owned and ghost cells from the vector, which has to have the locally relevant layout
+  // (the local indices in it are looked up in the first call after reinit(), then reused).
+  void gather(const TrilinosWrappers::MPI::Vector& vector);
+
+  // Values of the cell with the active cell index (in the cell layout).
+  inline const Number* cell_values(const unsigned int active_cell_index) const
+  {
+    return &this->values[active_cell_index * this->dofs_per_cell];
+  }
+
+  // Position in the cell layout of the i-th cell-local degree of freedom (in the deal.II order).
+  inline unsigned int position(const unsigned int i) const
+  {
+    return this->positions[i];
+  }
+
+  // The cell-local degree of freedom (in the deal.II order) at the position in the cell layout.
+  inline unsigned int dof(const unsigned int position) const
+  {
+    return this->dofs[position];
+  }
+
+  // First position of the block of the component c in the cell layout (c = n_components: the non-primitive block, c = n_components + 1: the end),
+  // the kernels loop over a block as for (p = block_start(c); p < block_start(c + 1); ++p).
+  inline unsigned int block_start(const unsigned int c) const
+  {
+    return this->block_starts[c];
+  }
+
+private:
+  unsigned int dofs_per_cell;
+  std::vector<unsigned int> positions, dofs, block_starts;
+  AlignedVector<Number> values;
+  // Global indices (until the first gather()), then the local indices in the vector, per cell and position (-1: artificial cell).
+  std::vector<types::global_dof_index> global_indices;
+  std::vector<int> local_indices;
+};
+
+#endif
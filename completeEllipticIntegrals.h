@@ -9,6 +9,7 @@
 
 #include <cmath>       // required for fabs(), fabsl(), sqrtl(), and M_PI_2
 #include <cfloat>      // required for LDBL_EPSILON, DBL_MAX
+#include <algorithm>   // required for std::max
 
 //static const long double PI_2 =  1.5707963267948966192313216916397514L; // pi/2
 static const long double PI_4 = 0.7853981633974483096156608458198757L; // pi/4
@@ -83,4 +84,9 @@ static const long double PI_4 = 0.7853981633974483096156608458198757L; // pi/4
 double Complete_Elliptic_Integral_First_Kind(char, double);
 double Complete_Elliptic_Integral_Second_Kind(char, double);
 void Complete_Elliptic_Integrals(char, double, double&, double&);
+// Modulus k, by the AGM (long double) - reference for the version below.
+void Complete_Elliptic_Integrals_Modulus_AGM(double, double&, double&);
+// Modulus k, by polynomial approximations - see completeEllipticIntegrals.cpp.
 void Complete_Elliptic_Integrals_Modulus(double, double&, double&);
+// Batched version: K[i], E[i] for the moduli k[i], i < n.
+void Complete_Elliptic_Integrals_Modulus(const double* k, double* K, double* E, unsigned int n);
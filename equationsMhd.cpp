@@ -81,18 +81,22 @@ std::array<double, dim> Equations<EquationsTypeMhd, dim>::compute_magnetic_field
 }
 
 template <int dim>
-void Equations<EquationsTypeMhd, dim>::compute_flux_matrix(const values_vector &W, std::array <std::array <double, dim>, n_components > &flux, const Parameters<dim>& parameters)
+template <typename Number>
+void Equations<EquationsTypeMhd, dim>::compute_flux_matrix(const std::array<Number, n_components> &W, std::array <std::array <Number, dim>, n_components > &flux, const Parameters<dim>& parameters)
 {
-  const double total_pressure = compute_total_pressure(W, parameters);
-  const double oneOverRho = 1. / W[0];
-  const double UB = (W[1] * W[5] + W[2] * W[6] + W[3] * W[7])* oneOverRho;
+  // compute_total_pressure() in Number.
+  const Number oneOverRho = Number(1.) / W[0];
+  const Number magnetic_energy = Number(0.5) * (W[5] * W[5] + W[6] * W[6] + W[7] * W[7]);
+  const Number kinetic_energy = Number(0.5) * (W[1] * W[1] + W[2] * W[2] + W[3] * W[3]) * oneOverRho;
+  const Number total_pressure = Number(parameters.gas_gamma - 1.0) * (W[4] - kinetic_energy - magnetic_energy) + magnetic_energy;
+  const Number UB = (W[1] * W[5] + W[2] * W[6] + W[3] * W[7])* oneOverRho;
 
   flux[0][0] = W[1];
   flux[1][0] = (W[1] * W[1] * oneOverRho) - W[5] * W[5] + total_pressure;
   flux[2][0] = (W[1] * W[2] * oneOverRho) - W[5] * W[6];
   flux[3][0] = (W[1] * W[3] * oneOverRho) - W[5] * W[7];
   flux[4][0] = (W[4] + total_pressure) * (W[1] * oneOverRho) - (W[5] * UB);
-  flux[5][0] = 0.0;
+  flux[5][0] = Number(0.);
   flux[6][0] = ((W[1] * oneOverRho) * W[6]) - ((W[2] * oneOverRho) * W[5]);
   flux[7][0] = ((W[1] * oneOverRho) * W[7]) - ((W[3] * oneOverRho) * W[5]);
 
@@ -102,7 +106,7 @@ void Equations<EquationsTypeMhd, dim>::compute_flux_matrix(const values_vector &
   flux[3][1] = (W[2] * W[3] * oneOverRho) - W[6] * W[7];
   flux[4][1] = (W[4] + total_pressure) * (W[2] * oneOverRho) - (W[6] * UB);
   flux[5][1] = ((W[2] * oneOverRho) * W[5]) - ((W[1] * oneOverRho) * W[6]);
-  flux[6][1] = 0.0;
+  flux[6][1] = Number(0.);
   flux[7][1] = ((W[2] * oneOverRho) * W[7]) - ((W[3] * oneOverRho) * W[6]);
 
   flux[0][2] = W[3];
@@ -112,7 +116,7 @@ void Equations<EquationsTypeMhd, dim>::compute_flux_matrix(const values_vector &
   flux[4][2] = (W[4] + total_pressure) * (W[3] * oneOverRho) - (W[7] * UB);
   flux[5][2] = ((W[3] * oneOverRho) * W[5]) - ((W[1] * oneOverRho) * W[7]);
   flux[6][2] = ((W[3] * oneOverRho) * W[6]) - ((W[2] * oneOverRho) * W[7]);
-  flux[7][2] = 0.0;
+  flux[7][2] = Number(0.);
 }
 
 template <int dim>
@@ -247,3 +251,7 @@ UpdateFlags Equations<EquationsTypeMhd, dim>::Postprocessor::get_needed_update_f
 }
 
 template class Equations<EquationsTypeMhd, 3>;
+template void Equations<EquationsTypeMhd, 3>::compute_flux_matrix<double>(const std::array<double, Equations<EquationsTypeMhd, 3>::n_components>&,
+  std::array<std::array<double, 3>, Equations<EquationsTypeMhd, 3>::n_components>&, const Parameters<3>&);
+template void Equations<EquationsTypeMhd, 3>::compute_flux_matrix<float>(const std::array<float, Equations<EquationsTypeMhd, 3>::n_components>&,
+  std::array<std::array<float, 3>, Equations<EquationsTypeMhd, 3>::n_components>&, const Parameters<3>&);
@@ -30,8 +30,9 @@ public:
   static double compute_magnetic_field_divergence(const std::vector<Tensor<1, dim> > &W);
   static std::array<double, dim> compute_magnetic_field_curl(const std::vector<Tensor<1, dim> > &W);
 
-  // Compute the matrix of MHD fluxes.
-  static void compute_flux_matrix(const values_vector &W, std::array <std::array <double, dim>, n_components > &flux, const Parameters<dim>& parameters);
+  // Compute the matrix of MHD fluxes - in double, or in float (Parameters::single_precision_storage).
+  template <typename Number>
+  static void compute_flux_matrix(const std::array<Number, n_components> &W, std::array <std::array <Number, dim>, n_components > &flux, const Parameters<dim>& parameters);
   static void compute_flux_vector(const Tensor<1, dim> &normal, const values_vector &W, std::array <double, n_components > &, const Parameters<dim>& parameters);
 
   // The rest is for the output.  
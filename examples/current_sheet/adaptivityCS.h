@@ -17,8 +17,7 @@ public:
     Triangulation<dim>& triangulation
 #endif
     , const Mapping<dim>& mapping);
-  
-  void calculate_jumps(TrilinosWrappers::MPI::Vector& solution, const DoFHandler<dim>& dof_handler, const Mapping<dim>& mapping, Vector<double>& gradient_indicator);
+
   int last_time_step;
   int adaptivity_step;
 
@@ -27,11 +26,6 @@ public:
   int perform_n_initial_refinements;
   double refine_threshold;
   double coarsen_threshold;
-  std::array <unsigned short, BASIS_FN_COUNT> component_ii;
-  std::array <bool, BASIS_FN_COUNT> is_primitive;
-  FEValuesExtractors::Vector mag;
-  std::vector<types::global_dof_index> dof_indices;
-  std::vector<types::global_dof_index> dof_indices_neighbor;
 };
 
 #endif
\ No newline at end of file
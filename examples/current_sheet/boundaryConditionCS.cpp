@@ -9,6 +9,12 @@ BoundaryConditionCSWithVortices<dim>::BoundaryConditionCSWithVortices(Parameters
 
 }
 
+template <int dim>
+int BoundaryConditionCSWithVortices<dim>::dependencies(int boundary_no) const
+{
+  return this->depends_on_time | this->depends_on_state;
+}
+
 
 
 template <int dim>
@@ -42,6 +48,12 @@ BoundaryConditionCSFree<dim>::BoundaryConditionCSFree(Parameters<dim>& parameter
 {
 }
 
+template <int dim>
+int BoundaryConditionCSFree<dim>::dependencies(int boundary_no) const
+{
+  return this->depends_on_state;
+}
+
 template <int dim>
 void BoundaryConditionCSFree<dim>::bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, 
   values_vector &result, const grad_vector &grads, const values_vector &values, double time, typename DoFHandler<dim>::active_cell_iterator&) const
@@ -57,6 +69,13 @@ BoundaryConditionCSTest<dim>::BoundaryConditionCSTest(Parameters<dim>& parameter
 {
 }
 
+template <int dim>
+int BoundaryConditionCSTest<dim>::dependencies(int boundary_no) const
+{
+  // bc_vector_value() currently returns right after the do-nothing part.
+  return this->depends_on_state;
+}
+
 template <int dim>
 void BoundaryConditionCSTest<dim>::bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, 
   values_vector &result, const grad_vector &grads, const values_vector &values, double time, typename DoFHandler<dim>::active_cell_iterator& cell) const
@@ -81,8 +100,7 @@ void BoundaryConditionCSTest<dim>::bc_vector_value(int boundary_no, const Point<
   // \frac{\partial B^{'}_x}{\partial x} = -\left(\frac{\partial B_y}{\partial y} + \frac{\partial B_z}{\partial z} \right)
   // We want a linear reconstruction B^{'} = B + d * \frac{\partial B^{'}_x}{\partial x}
   // d will be taken as the elementh length in the direction.
-  // Assumption: we have cubes.
-  double d = std::pow(cell->measure(), 1./3.);
+  double d = cell_extent_along(cell, normal);
   // In order to have value (and not just the derivative).
   // \left|B^{'}_x}\right| = \left|B_x}\right|
 
@@ -129,29 +147,54 @@ BoundaryConditionCSInitialState<dim>::BoundaryConditionCSInitialState(Parameters
 {
 }
 
+template <int dim>
+int BoundaryConditionCSInitialState<dim>::dependencies(int boundary_no) const
+{
+  // Only depends on the position.
+  return 0;
+}
+
 template <int dim>
 void BoundaryConditionCSInitialState<dim>::bc_vector_value(int boundary_no, const Point<dim> &p, const Tensor<1, dim> &normal, 
   values_vector &result, const grad_vector &grads, const values_vector &values, double time, typename DoFHandler<dim>::active_cell_iterator& cell) const
 {
-  std::vector<Point<dim> > points;
-  Point<dim> p1;
+  ic_points.resize(1);
+  ic_values.resize(1);
   for (unsigned int di = 0; di < dim; ++di)
   {
     double length_in_direction = (this->parameters.corner_b[di] - this->parameters.corner_a[di]) / this->parameters.refinements[di];
-    p1[di] = p[di] + (0.5 * normal[di] * length_in_direction);
+    ic_points[0][di] = p[di] + (0.5 * normal[di] * length_in_direction);
   }
-  points.push_back(p1);
-  std::array<double, Equations<EquationsTypeMhd, dim>::n_components> vla;
-  std::vector<std::array<double, Equations<EquationsTypeMhd, dim>::n_components> > vl;
-  vl.push_back(vla);
-  ic.vector_value(points, vl);
+  ic.vector_value(ic_points, ic_values);
   for (unsigned int di = 0; di < Equations<EquationsTypeMhd, dim>::n_components; ++di)
-    result[di] = vl[0][di];
+    result[di] = ic_values[0][di];
   //result[0] = values[0];
   result[1] = result[2] = result[3] = 0.;
   //result[4] = Equations<EquationsTypeMhd, dim>::compute_energy_from_pressure(result, this->cs_parameters.beta, this->parameters);
 }
 
+template <int dim>
+void BoundaryConditionCSInitialState<dim>::bc_vector_values(int boundary_no, const std::vector<Point<dim> > &points, const std::vector<Tensor<1, dim> > &normals,
+  std::vector<values_vector> &results, const std::vector<grad_vector> &grads, const std::vector<values_vector> &values, double time, typename DoFHandler<dim>::active_cell_iterator& cell) const
+{
+  // All points of the face in one evaluation of the initial condition.
+  ic_points.resize(points.size());
+  ic_values.resize(points.size());
+  for (unsigned int q = 0; q < points.size(); ++q)
+    for (unsigned int di = 0; di < dim; ++di)
+    {
+      double length_in_direction = (this->parameters.corner_b[di] - this->parameters.corner_a[di]) / this->parameters.refinements[di];
+      ic_points[q][di] = points[q][di] + (0.5 * normals[q][di] * length_in_direction);
+    }
+  ic.vector_value(ic_points, ic_values);
+  for (unsigned int q = 0; q < points.size(); ++q)
+  {
+    for (unsigned int di = 0; di < Equations<EquationsTypeMhd, dim>::n_components; ++di)
+      results[q][di] = ic_values[q][di];
+    results[q][1] = results[q][2] = results[q][3] = 0.;
+  }
+}
+
 template class BoundaryConditionCSWithVortices<3>;
 template class BoundaryConditionCSFree<3>;
 template class BoundaryConditionCSInitialState<3>;
@@ -18,6 +18,8 @@ public:
 
   BoundaryConditionCSWithVortices(Parameters<dim>&, CSParameters&);
 
+  int dependencies(int boundary_no) const;
+
   void bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, values_vector &result, 
     const grad_vector &grads, const values_vector &W_plus, double time, typename DoFHandler<dim>::active_cell_iterator&) const;
 
@@ -41,6 +43,8 @@ public:
 
   BoundaryConditionCSFree(Parameters<dim>&, CSParameters&);
 
+  int dependencies(int boundary_no) const;
+
   void bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, values_vector &result, 
     const grad_vector &grads, const values_vector &W_plus, double time, typename DoFHandler<dim>::active_cell_iterator&) const;
 };
@@ -54,6 +58,8 @@ public:
 
   BoundaryConditionCSTest(Parameters<dim>&, CSParameters&);
 
+  int dependencies(int boundary_no) const;
+
   void bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, values_vector &result, 
     const grad_vector &grads, const values_vector &W_plus, double time, typename DoFHandler<dim>::active_cell_iterator&) const;
 private:
@@ -69,12 +75,20 @@ public:
 
   BoundaryConditionCSInitialState(Parameters<dim>&, CSParameters&);
 
+  int dependencies(int boundary_no) const;
+
   void bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, values_vector &result,
     const grad_vector &grads, const values_vector &W_plus, double time, typename DoFHandler<dim>::active_cell_iterator&) const;
 
+  void bc_vector_values(int boundary_no, const std::vector<Point<dim> > &points, const std::vector<Tensor<1, dim> > &normals, std::vector<values_vector> &results,
+    const std::vector<grad_vector> &grads, const std::vector<values_vector> &W_plus, double time, typename DoFHandler<dim>::active_cell_iterator&) const;
+
 private:
   CSParameters& cs_parameters;
   InitialConditionCS<EquationsTypeMhd, dim> ic;
+  // Scratch for evaluating the initial condition (only grows).
+  mutable std::vector<Point<dim> > ic_points;
+  mutable std::vector<values_vector> ic_values;
   double invL_G;
   double iSgn;
   double d2R;
@@ -18,7 +18,7 @@ void set_triangulation(parallel::distributed::Triangulation<DIMENSION>& triangul
 void set_triangulation(Triangulation<DIMENSION>& triangulation, Parameters<DIMENSION>& parameters)
 #endif
 {
-  GridGenerator::subdivided_hyper_rectangle(triangulation, parameters.refinements, parameters.corner_a, parameters.corner_b, true);
+  parameters.coarse_mesh_refinements = create_box(triangulation, parameters.refinements, parameters.corner_a, parameters.corner_b, parameters.periodic_boundaries);
 }
 
 void set_parameters(Parameters<DIMENSION>& parameters, CSParameters& cs_parameters)
@@ -104,6 +104,14 @@ int main(int argc, char *argv[])
     Parameters<DIMENSION> parameters;
     CSParameters cs_parameters;
     set_parameters(parameters, cs_parameters);
+    // Values from the parameter file and the command line (see read_parameters() in parameters.h) override the ones set above.
+    ParameterHandler prm;
+    parameters.declare_parameters(prm);
+    cs_parameters.declare_parameters(prm);
+    read_parameters(prm, argc, argv);
+    parameters.parse_parameters(prm);
+    cs_parameters.parse_parameters(prm);
+    print_parameters(prm, parameters.output_file_prefix, mpi_communicator);
     parameters.delete_old_outputs(mpi_communicator);
 
     // Declaration of triangulation. The triangulation is not initialized here, but rather in the constructor of Parameters class.
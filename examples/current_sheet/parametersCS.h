@@ -1,8 +1,15 @@
 #ifndef _PARAMETERS_CS_H
 #define _PARAMETERS_CS_H
 
+#include "util.h"
+
 struct CSParameters
 {
+  // Declares the parameters in the section "Current sheet" of prm, with the current values as defaults.
+  void declare_parameters(ParameterHandler& prm) const;
+  // Reads the values of the parameters declared by declare_parameters().
+  void parse_parameters(ParameterHandler& prm);
+
   // plasma beta
   double beta;
 
@@ -16,8 +16,7 @@ public:
     Triangulation<dim>& triangulation
 #endif
     , const Mapping<dim>& mapping);
-  
-  void calculate_jumps(TrilinosWrappers::MPI::Vector& solution, const DoFHandler<dim>& dof_handler, const Mapping<dim>& mapping, Vector<double>& gradient_indicator);
+
   int last_time_step;
   int adaptivity_step;
 };
@@ -16,12 +16,7 @@ void set_triangulation(parallel::distributed::Triangulation<DIMENSION>& triangul
 void set_triangulation(Triangulation<DIMENSION>& triangulation, Parameters<DIMENSION>& parameters)
 #endif
 {
-  GridGenerator::subdivided_hyper_rectangle(triangulation, parameters.refinements, parameters.corner_a, parameters.corner_b, true);
-
-  std::vector<dealii::GridTools::PeriodicFacePair< dealii::TriaIterator<dealii::CellAccessor<DIMENSION> > > > matched_pairs;
-  for (std::vector<std::array<int, 3> >::const_iterator it = parameters.periodic_boundaries.begin(); it != parameters.periodic_boundaries.end(); it++)
-    dealii::GridTools::collect_periodic_faces(triangulation, (*it)[0], (*it)[1], (*it)[2], matched_pairs);
-  triangulation.add_periodicity(matched_pairs);
+  parameters.coarse_mesh_refinements = create_box(triangulation, parameters.refinements, parameters.corner_a, parameters.corner_b, parameters.periodic_boundaries);
 }
 
 void set_parameters(Parameters<DIMENSION>& parameters)
@@ -71,6 +66,12 @@ int main(int argc, char *argv[])
     // Initialization of parameters. See parameters.h for description of the individual parameters
     Parameters<DIMENSION> parameters;
     set_parameters(parameters);
+    // Values from the parameter file and the command line (see read_parameters() in parameters.h) override the ones set above.
+    ParameterHandler prm;
+    parameters.declare_parameters(prm);
+    read_parameters(prm, argc, argv);
+    parameters.parse_parameters(prm);
+    print_parameters(prm, parameters.output_file_prefix, mpi_communicator);
     parameters.delete_old_outputs(mpi_communicator);
 
     // Declaration of triangulation. The triangulation is not initialized here, but rather in the constructor of Parameters class.
@@ -11,6 +11,13 @@ BoundaryConditionTDWithVortices<dim>::BoundaryConditionTDWithVortices(Parameters
   y_2 = -this->eps * td_parameters.R;
 }
 
+template <int dim>
+int BoundaryConditionTDWithVortices<dim>::dependencies(int boundary_no) const
+{
+  // omega(time) drives the vortices, the rest is taken from the interior.
+  return this->depends_on_time | this->depends_on_state;
+}
+
 template <int dim>
 double BoundaryConditionTDWithVortices<dim>::r_1_bar(double x, double y) const
 {
@@ -42,8 +49,7 @@ double BoundaryConditionTDWithVortices<dim>::omega(double time) const
 }
 
 template <int dim>
-void BoundaryConditionTDWithVortices<dim>::bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, 
-  values_vector &result, const grad_vector &grads, const values_vector &values, double time, typename DoFHandler<dim>::active_cell_iterator&) const
+void BoundaryConditionTDWithVortices<dim>::ghost_state(const Point<dim> &point, double omega_t, values_vector &result, const values_vector &values) const
 {
   // For other than z=0 boundaries, we use do-nothing
   if (point[2] > SMALL)
@@ -55,8 +61,8 @@ void BoundaryConditionTDWithVortices<dim>::bc_vector_value(int boundary_no, cons
 
   double x = point[0], y = point[1];
   result[0] = values[0];
-  result[1] = result[0] * (-omega(time) * this->eps * ((y - y_1) * omega_1(x, y) + (y - y_2) * omega_2(x, y)));
-  result[2] = result[0] * (omega(time) * (x / this->eps) * (omega_1(x, y) + omega_2(x, y)));
+  result[1] = result[0] * (-omega_t * this->eps * ((y - y_1) * omega_1(x, y) + (y - y_2) * omega_2(x, y)));
+  result[2] = result[0] * (omega_t * (x / this->eps) * (omega_1(x, y) + omega_2(x, y)));
   result[3] = 0.0;
 
   // energy density
@@ -67,12 +73,34 @@ void BoundaryConditionTDWithVortices<dim>::bc_vector_value(int boundary_no, cons
   result[7] = values[7];
 }
 
+template <int dim>
+void BoundaryConditionTDWithVortices<dim>::bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, 
+  values_vector &result, const grad_vector &grads, const values_vector &values, double time, typename DoFHandler<dim>::active_cell_iterator&) const
+{
+  ghost_state(point, omega(time), result, values);
+}
+
+template <int dim>
+void BoundaryConditionTDWithVortices<dim>::bc_vector_values(int boundary_no, const std::vector<Point<dim> > &points, const std::vector<Tensor<1, dim> > &normals,
+  std::vector<values_vector> &results, const std::vector<grad_vector> &grads, const std::vector<values_vector> &values, double time, typename DoFHandler<dim>::active_cell_iterator&) const
+{
+  const double omega_t = omega(time);
+  for (unsigned int q = 0; q < points.size(); ++q)
+    ghost_state(points[q], omega_t, results[q], values[q]);
+}
+
 template <int dim>
 BoundaryConditionTDFree<dim>::BoundaryConditionTDFree(Parameters<dim>& parameters, TitovDemoulinParameters& td_parameters) :
   BoundaryCondition<EquationsTypeMhd, dim>(parameters)
 {
 }
 
+template <int dim>
+int BoundaryConditionTDFree<dim>::dependencies(int boundary_no) const
+{
+  return this->depends_on_state;
+}
+
 template <int dim>
 void BoundaryConditionTDFree<dim>::bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, 
   values_vector &result, const grad_vector &grads, const values_vector &values, double time, typename DoFHandler<dim>::active_cell_iterator&) const
@@ -89,8 +117,14 @@ BoundaryConditionTDTest<dim>::BoundaryConditionTDTest(Parameters<dim>& parameter
 }
 
 template <int dim>
-void BoundaryConditionTDTest<dim>::bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, 
-  values_vector &result, const grad_vector &grads, const values_vector &values, double time, typename DoFHandler<dim>::active_cell_iterator& cell) const
+int BoundaryConditionTDTest<dim>::dependencies(int boundary_no) const
+{
+  // The magnetic field is extrapolated using the interior gradients.
+  return this->depends_on_state | this->depends_on_gradients;
+}
+
+template <int dim>
+void BoundaryConditionTDTest<dim>::ghost_state(int boundary_no, const Tensor<1, dim> &normal, double d, values_vector &result, const grad_vector &grads, const values_vector &values) const
 {
   // Density the same.
   result[0] = values[0];
@@ -108,9 +142,7 @@ void BoundaryConditionTDTest<dim>::bc_vector_value(int boundary_no, const Point<
   // From divergence-free constraint. Here for x-direction:
   // \frac{\partial B^{'}_x}{\partial x} = -\left(\frac{\partial B_y}{\partial y} + \frac{\partial B_z}{\partial z} \right)
   // We want a linear reconstruction B^{'} = B + d * \frac{\partial B^{'}_x}{\partial x}
-  // d will be taken as the elementh length in the direction.
-  // Assumption: we have cubes.
-  double d = std::pow(cell->measure(), 1./3.);
+  // d will be taken as the elementh length in the direction (passed as a parameter).
   // In order to have value (and not just the derivative).
   // \left|B^{'}_x}\right| = \left|B_x}\right|
 
@@ -146,6 +178,24 @@ void BoundaryConditionTDTest<dim>::bc_vector_value(int boundary_no, const Point<
   result[4] = values[4];
 }
 
+template <int dim>
+void BoundaryConditionTDTest<dim>::bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, 
+  values_vector &result, const grad_vector &grads, const values_vector &values, double time, typename DoFHandler<dim>::active_cell_iterator& cell) const
+{
+  // The element length in the normal direction.
+  ghost_state(boundary_no, normal, cell_extent_along(cell, normal), result, grads, values);
+}
+
+template <int dim>
+void BoundaryConditionTDTest<dim>::bc_vector_values(int boundary_no, const std::vector<Point<dim> > &points, const std::vector<Tensor<1, dim> > &normals,
+  std::vector<values_vector> &results, const std::vector<grad_vector> &grads, const std::vector<values_vector> &values, double time, typename DoFHandler<dim>::active_cell_iterator& cell) const
+{
+  // The element length in the normal direction - computed once per face (which is axis-aligned).
+  const double d = cell_extent_along(cell, normals[0]);
+  for (unsigned int q = 0; q < points.size(); ++q)
+    ghost_state(boundary_no, normals[q], d, results[q], grads[q], values[q]);
+}
+
 template <int dim>
 BoundaryConditionTDInitialState<dim>::BoundaryConditionTDInitialState(Parameters<dim>& parameters, TitovDemoulinParameters& td_parameters) :
   BoundaryCondition<EquationsTypeMhd, dim>(parameters), td_parameters(td_parameters),
@@ -154,26 +204,53 @@ BoundaryConditionTDInitialState<dim>::BoundaryConditionTDInitialState(Parameters
 }
 
 template <int dim>
-void BoundaryConditionTDInitialState<dim>::bc_vector_value(int boundary_no, const Point<dim> &p, const Tensor<1, dim> &normal, 
-  values_vector &result, const grad_vector &grads, const values_vector &values, double time, typename DoFHandler<dim>::active_cell_iterator& cell) const
+int BoundaryConditionTDInitialState<dim>::dependencies(int boundary_no) const
+{
+  // Only depends on the position.
+  return 0;
+}
+
+template <int dim>
+Point<dim> BoundaryConditionTDInitialState<dim>::ghost_point(const Point<dim> &p, const Tensor<1, dim> &normal) const
 {
-  std::vector<Point<dim> > points;
   Point<dim> p1;
   for (unsigned int di = 0; di < dim; ++di)
   {
     double length_in_direction = (this->parameters.corner_b[di] - this->parameters.corner_a[di]) / this->parameters.refinements[di];
     p1[di] = p[di] + (0.5 * normal[di] * length_in_direction);
   }
-  points.push_back(p1);
-  std::array<double, Equations<EquationsTypeMhd, dim>::n_components> vla;
-  std::vector<std::array<double, Equations<EquationsTypeMhd, dim>::n_components> > vl;
-  vl.push_back(vla);
-  ic.vector_value(points, vl);
+  return p1;
+}
+
+template <int dim>
+void BoundaryConditionTDInitialState<dim>::bc_vector_value(int boundary_no, const Point<dim> &p, const Tensor<1, dim> &normal, 
+  values_vector &result, const grad_vector &grads, const values_vector &values, double time, typename DoFHandler<dim>::active_cell_iterator& cell) const
+{
+  ic_points.assign(1, ghost_point(p, normal));
+  ic_values.resize(1);
+  ic.vector_value(ic_points, ic_values);
   for (unsigned int di = 0; di < Equations<EquationsTypeMhd, dim>::n_components; ++di)
-    result[di] = vl[0][di];
-  //result[0] = values[0];
+    result[di] = ic_values[0][di];
   result[1] = result[2] = result[3] = 0.;
-  //result[4] = Equations<EquationsTypeMhd, dim>::compute_energy_from_pressure(result, this->td_parameters.beta, this->parameters);
+}
+
+template <int dim>
+void BoundaryConditionTDInitialState<dim>::bc_vector_values(int boundary_no, const std::vector<Point<dim> > &points, const std::vector<Tensor<1, dim> > &normals,
+  std::vector<values_vector> &results, const std::vector<grad_vector> &grads, const std::vector<values_vector> &values, double time, typename DoFHandler<dim>::active_cell_iterator& cell) const
+{
+  // All points of the face are evaluated in one batch (Problem caches the values per face until refinement).
+  ic_points.resize(points.size());
+  for (unsigned int q = 0; q < points.size(); ++q)
+    ic_points[q] = ghost_point(points[q], normals[q]);
+  ic_values.resize(points.size());
+  ic.vector_value(ic_points, ic_values);
+
+  for (unsigned int q = 0; q < points.size(); ++q)
+  {
+    for (unsigned int di = 0; di < Equations<EquationsTypeMhd, dim>::n_components; ++di)
+      results[q][di] = ic_values[q][di];
+    results[q][1] = results[q][2] = results[q][3] = 0.;
+  }
 }
 
 template class BoundaryConditionTDWithVortices<3>;
@@ -18,9 +18,14 @@ public:
 
   BoundaryConditionTDWithVortices(Parameters<dim>&, TitovDemoulinParameters&);
 
+  int dependencies(int boundary_no) const;
+
   void bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, values_vector &result, 
     const grad_vector &grads, const values_vector &W_plus, double time, typename DoFHandler<dim>::active_cell_iterator&) const;
 
+  void bc_vector_values(int boundary_no, const std::vector<Point<dim> > &points, const std::vector<Tensor<1, dim> > &normals, std::vector<values_vector> &results,
+    const std::vector<grad_vector> &grads, const std::vector<values_vector> &W_plus, double time, typename DoFHandler<dim>::active_cell_iterator&) const;
+
 private:
   TitovDemoulinParameters& td_parameters;
   double eps;
@@ -30,6 +35,8 @@ private:
   double omega_1(double x, double y) const;
   double omega_2(double x, double y) const;
   double omega(double time) const;
+  // The state for the given omega(time).
+  void ghost_state(const Point<dim> &point, double omega_t, values_vector &result, const values_vector &W_plus) const;
 };
 
 template <int dim>
@@ -41,6 +48,8 @@ public:
 
   BoundaryConditionTDFree(Parameters<dim>&, TitovDemoulinParameters&);
 
+  int dependencies(int boundary_no) const;
+
   void bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, values_vector &result, 
     const grad_vector &grads, const values_vector &W_plus, double time, typename DoFHandler<dim>::active_cell_iterator&) const;
 };
@@ -54,10 +63,17 @@ public:
 
   BoundaryConditionTDTest(Parameters<dim>&, TitovDemoulinParameters&);
 
+  int dependencies(int boundary_no) const;
+
   void bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, values_vector &result, 
     const grad_vector &grads, const values_vector &W_plus, double time, typename DoFHandler<dim>::active_cell_iterator&) const;
+
+  void bc_vector_values(int boundary_no, const std::vector<Point<dim> > &points, const std::vector<Tensor<1, dim> > &normals, std::vector<values_vector> &results,
+    const std::vector<grad_vector> &grads, const std::vector<values_vector> &W_plus, double time, typename DoFHandler<dim>::active_cell_iterator&) const;
 private:
   TitovDemoulinParameters& td_parameters;
+  // The state for the given cell size d.
+  void ghost_state(int boundary_no, const Tensor<1, dim> &normal, double d, values_vector &result, const grad_vector &grads, const values_vector &W_plus) const;
 };
 
 template <int dim>
@@ -69,12 +85,22 @@ public:
 
   BoundaryConditionTDInitialState(Parameters<dim>&, TitovDemoulinParameters&);
 
+  int dependencies(int boundary_no) const;
+
   void bc_vector_value(int boundary_no, const Point<dim> &point, const Tensor<1, dim> &normal, values_vector &result,
     const grad_vector &grads, const values_vector &W_plus, double time, typename DoFHandler<dim>::active_cell_iterator&) const;
 
+  void bc_vector_values(int boundary_no, const std::vector<Point<dim> > &points, const std::vector<Tensor<1, dim> > &normals, std::vector<values_vector> &results,
+    const std::vector<grad_vector> &grads, const std::vector<values_vector> &W_plus, double time, typename DoFHandler<dim>::active_cell_iterator&) const;
+
 private:
   TitovDemoulinParameters& td_parameters;
   InitialConditionTitovDemoulin<EquationsTypeMhd, dim> ic;
+  // Point (outside of the domain) where the initial state is taken.
+  Point<dim> ghost_point(const Point<dim> &point, const Tensor<1, dim> &normal) const;
+  // Scratch for evaluating the initial condition.
+  mutable std::vector<Point<dim> > ic_points;
+  mutable std::vector<values_vector> ic_values;
   double invL_G;
   double iSgn;
   double d2R;
@@ -25,6 +25,17 @@ InitialConditionTitovDemoulin<equationsType, dim>::InitialConditionTitovDemoulin
   // This would reflect q_{maq} to be |q| from page 10/456 of https://github.com/l-korous/doctoral-thesis/blob/master/_reference/Modeling%20of%20H%CE%B1%20Eruptive%20Events%20Observed%20at%20the%20Solar.pdf
 }
 
+// f(k) = ((2 - k^2) K(k) - 2 E(k)) / k of the toroidal vector potential, and its first two derivatives (using dK/dk = E / (k (1 - k^2)) - K / k, dE/dk = (E - K) / k).
+static void torus_potential_factor(double k, double K, double E, double& f, double& f_prime, double& f_second)
+{
+  const double m1 = 1. - k * k;
+  f = ((2. - k * k) * K - 2. * E) / k;
+  f_prime = E / m1 - K - f / k;
+  const double K_prime = E / (k * m1) - K / k;
+  const double E_prime = (E - K) / k;
+  f_second = E_prime / m1 + 2. * k * E / (m1 * m1) - K_prime - f_prime / k + f / (k * k);
+}
+
 /***************************************************************************
 Calculate the field according to TD paper (A&A 351, 707, 1999)
 Fill the structure with gravity-stratified plasma.
@@ -32,12 +43,26 @@ Fill the structure with gravity-stratified plasma.
 template <EquationsType equationsType, int dim>
 void InitialConditionTitovDemoulin<equationsType, dim>::vector_value(const std::vector<Point<dim> > &points, std::vector<std::array<double, Equations<equationsType, dim>::n_components> >& value_list) const
 {
-  //========== Calculate the vector potential for I_t-generated toroidal field 
   double xx, yy, zz;
   Point<dim> &ca = this->parameters.corner_a;
   Point<dim> &cb = this->parameters.corner_b;
-  const double dd = SMALL;  // precision of numerical derivatives
-  const double idd = 0.5 / dd;
+  const double R = this->td_parameters.R;
+
+  // The elliptic integrals for all points are evaluated in one batch - of the modulus kr in the external region, ka inside the torus (see below).
+  std::vector<double> moduli(points.size()), K(points.size()), E(points.size());
+  for (unsigned int pp = 0; pp < points.size(); ++pp)
+  {
+    xx = points[pp][0] - (ca[0] + cb[0]) * 0.5;
+    yy = points[pp][1] - (ca[1] + cb[1]) * 0.5;
+    zz = points[pp][2] - ca[2];
+    const double r_maj = sqrt(yy * yy + (zz + d2R * R) * (zz + d2R * R));
+    const double r_min = sqrt(xx * xx + (r_maj - R) * (r_maj - R));
+    if (r_min > td_parameters.r)
+      moduli[pp] = 2.0 * sqrt(r_maj * R / ((r_maj + R) * (r_maj + R) + xx * xx));
+    else
+      moduli[pp] = 2.0 * sqrt(r_maj * R / (4.0 * r_maj * R + td_parameters.r * td_parameters.r));
+  }
+  Complete_Elliptic_Integrals_Modulus(moduli.data(), K.data(), E.data(), points.size());
 
   for (unsigned int pp = 0; pp < points.size(); ++pp)
   {
@@ -47,87 +72,55 @@ void InitialConditionTitovDemoulin<equationsType, dim>::vector_value(const std::
     yy = p[1] - (ca[1] + cb[1]) * 0.5;
     zz = p[2] - ca[2];
 
-    Vector<double> theta0(3);
-    double r_maj, r_min;
-    double df[6][3];
-    double P[6][3];
-    double dP[3][3];
-
-    // calculate vector potential in 6 close points (+dx,-dx,+dy,-dy,+dz,-dz)
-    for (unsigned int i = 0; i < 6; ++i) {
-      df[i][0] = df[i][1] = df[i][2] = 0.0;
-      df[i][int(i / 2)] = double(1 - 2 * int(i % 2)) * dd;
-    }
-
-    for (unsigned int i = 0; i < 6; ++i) {
-      double x = xx + df[i][0];
-      double y = yy + df[i][1];
-      double z = zz + df[i][2];
-
-      // Distances from torus major and minor axes
-      r_maj = sqrt(y * y + (z + d2R * this->td_parameters.R) * (z + d2R * this->td_parameters.R));
-      r_min = sqrt(x * x + (r_maj - this->td_parameters.R) * (r_maj - this->td_parameters.R));
-
-      // Unit vector of toroidal coordinate theta
-      theta0[0] = 0.0;
-      theta0[1] = -(z + this->td_parameters.d) / r_maj;
-      theta0[2] = y / r_maj;
-
-      // Common radial factor for A_tor
-      double rFactor = fabs(this->td_parameters.N_t) * sqrt(1.0 / (this->td_parameters.R * r_maj));
-
-      // Argument of elliptical integral
-      double kr = 2.0 * sqrt(r_maj * this->td_parameters.R / ((r_maj + this->td_parameters.R) * (r_maj + this->td_parameters.R) + x * x));
-
-      //---- Sew-up internal and external solutions
-      if (r_min > td_parameters.r) { //---- external region 
-        // Elliptical integrals
-        double Ek, Kk;
-        Complete_Elliptic_Integrals_Modulus(kr, Kk, Ek);
-
-        double Ak = ((2.0 - kr * kr) * Kk - 2.0 * Ek) / kr;
-
-        P[i][0] = (rFactor * Ak) * theta0[0];
-        P[i][1] = (rFactor * Ak) * theta0[1];
-        P[i][2] = (rFactor * Ak) * theta0[2];
-
-      }
-      else { //---- inside the torus
-
-        // ka=kr at r_min=1 (=torus surface) 
-        double ka = 2.0 * sqrt(r_maj * td_parameters.R / (4.0 * r_maj * this->td_parameters.R + td_parameters.r * td_parameters.r));
-
-        double Ek, Kk;
-        Complete_Elliptic_Integrals_Modulus(ka, Kk, Ek);
+    // Distances from torus major and minor axes
+    double r_maj = sqrt(yy * yy + (zz + d2R * R) * (zz + d2R * R));
+    double r_min = sqrt(xx * xx + (r_maj - R) * (r_maj - R));
 
-        double Ak = ((2.0 - ka * ka) * Kk - 2.0 * Ek) / ka;
-        double Ak_prime = ((2.0 - ka * ka) * Ek - 2.0 * (1.0 - ka * ka) * Kk) / (ka * ka * (1.0 - ka * ka));
+    // Unit vector of toroidal coordinate theta
+    Vector<double> theta0(3);
+    theta0[0] = 0.0;
+    theta0[1] = -(zz + d2R * R) / r_maj;
+    theta0[2] = yy / r_maj;
 
-        double cf = (rFactor * (Ak + Ak_prime*(kr - ka)));
-        P[i][0] = cf * theta0[0];
-        P[i][1] = cf * theta0[1];
-        P[i][2] = cf * theta0[2];
-      }
+    //========== Vector potential for I_t-generated toroidal field A = A_tor(x, r_maj) * theta0
+    // A_tor = rFactor(r_maj) * a(x, r_maj), where a is given by the elliptic integrals of the modulus kr (external region),
+    // or by their linearization around ka (= kr at the torus surface) inside the torus.
+    // Everything is differentiated analytically, so that B = curl A needs a single evaluation of the elliptic integrals.
+
+    // Common radial factor for A_tor
+    const double rFactor = fabs(this->td_parameters.N_t) * sqrt(1.0 / (R * r_maj));
+    const double rFactor_r = -0.5 * rFactor / r_maj;
+
+    // Argument of elliptical integral, and its derivatives wrt. x and r_maj
+    const double D = (r_maj + R) * (r_maj + R) + xx * xx;
+    const double kr = 2.0 * sqrt(r_maj * R / D);
+    const double kr_x = -kr * xx / D;
+    const double kr_r = kr * (0.5 / r_maj - (r_maj + R) / D);
+
+    double a, a_x, a_r, f, f_prime, f_second;
+    //---- Sew-up internal and external solutions
+    if (r_min > td_parameters.r) { //---- external region
+      torus_potential_factor(kr, K[pp], E[pp], f, f_prime, f_second);
+      a = f;
+      a_x = f_prime * kr_x;
+      a_r = f_prime * kr_r;
     }
-
-    // calculate derivatives of vector potential
-    for (unsigned int i = 0; i < 3; ++i) {
-      dP[i][0] = (P[2 * i][0] - P[2 * i + 1][0]) * idd;
-      dP[i][1] = (P[2 * i][1] - P[2 * i + 1][1]) * idd;
-      dP[i][2] = (P[2 * i][2] - P[2 * i + 1][2]) * idd;
+    else { //---- inside the torus
+      // ka=kr at r_min=1 (=torus surface)
+      const double Da = 4.0 * r_maj * R + td_parameters.r * td_parameters.r;
+      const double ka = 2.0 * sqrt(r_maj * R / Da);
+      const double ka_r = ka * (0.5 / r_maj - 2.0 * R / Da);
+      torus_potential_factor(ka, K[pp], E[pp], f, f_prime, f_second);
+      a = f + f_prime * (kr - ka);
+      a_x = f_prime * kr_x;
+      a_r = f_second * ka_r * (kr - ka) + f_prime * kr_r;
     }
+    const double A_tor = rFactor * a;
+    const double A_tor_x = rFactor * a_x;
+    const double A_tor_r = rFactor_r * a + rFactor * a_r;
 
     //====================== Calculate the full state field
 
-    // Distances from torus major and minor axes
-    r_maj = sqrt(yy * yy + (zz + d2R * this->td_parameters.R) * (zz + d2R * this->td_parameters.R));
-    r_min = sqrt(xx * xx + (r_maj - this->td_parameters.R) * (r_maj - this->td_parameters.R));
-
-    // Unit vector of toroidal coordinate theta
-    theta0[0] = 0.0;
-    theta0[1] = -(zz + d2R * this->td_parameters.R) / r_maj;
-    theta0[2] = yy / r_maj;
-
     // Radius vectors originating in magnetic charges
     Vector<double> r_plus(3);//(xx - L2R * R, yy, zz + d2R * R);
     r_plus[0] = xx - this->td_parameters.L;
@@ -149,10 +142,11 @@ void InitialConditionTitovDemoulin<equationsType, dim>::vector_value(const std::
     Vector<double> B_loc(3);//=cf1*r_plus-cf2*r_minus;
     B_loc.sadd(0.0, cf1, r_plus, -cf2, r_minus);
 
-    // Add vector potential part B = curl A
-    B_loc[0] += dP[1][2] - dP[2][1];
-    B_loc[1] += dP[2][0] - dP[0][2];
-    B_loc[2] += dP[0][1] - dP[1][0];
+    // Add vector potential part B = curl A - in the cylindrical coordinates (x, r_maj, theta) around the torus axis,
+    // B = (A_tor / r_maj + dA_tor/dr_maj) e_x - dA_tor/dx e_r, with e_r = (0, theta0[2], -theta0[1]).
+    B_loc[0] += A_tor / r_maj + A_tor_r;
+    B_loc[1] -= A_tor_x * theta0[2];
+    B_loc[2] += A_tor_x * theta0[1];
 
     /*
     barta@asu.cas.cz
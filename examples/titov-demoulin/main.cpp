@@ -18,7 +18,7 @@ void set_triangulation(parallel::distributed::Triangulation<DIMENSION>& triangul
 void set_triangulation(Triangulation<DIMENSION>& triangulation, Parameters<DIMENSION>& parameters)
 #endif
 {
-  GridGenerator::subdivided_hyper_rectangle(triangulation, parameters.refinements, parameters.corner_a, parameters.corner_b, true);
+  parameters.coarse_mesh_refinements = create_box(triangulation, parameters.refinements, parameters.corner_a, parameters.corner_b, parameters.periodic_boundaries);
 }
 
 void set_parameters(Parameters<DIMENSION>& parameters, TitovDemoulinParameters& td_parameters)
@@ -40,6 +40,9 @@ void set_parameters(Parameters<DIMENSION>& parameters, TitovDemoulinParameters&
   parameters.output_step = 5.e-1;
   parameters.final_time = 12.;
   parameters.output_file_prefix = "vtx_limit";
+  // Photosphere (z = 0) and mid-plane (x = 0) slices.
+  parameters.output_planes = { { 2, 0. }, { 0, 0. } };
+  parameters.output_slices_step = 1.e-1;
 
   parameters.max_cells = 2500;
   parameters.refine_every_nth_time_step = 25;
@@ -55,16 +58,6 @@ void set_parameters(Parameters<DIMENSION>& parameters, TitovDemoulinParameters&
   // coronal height scale
   td_parameters.L_G = 20.;
 
-  // Gravity acceleration
-  // g = ( l_0 / v^2_0 ) g
-  if (td_parameters.L_G > NEGLIGIBLE)
-  {
-    double l_0 = 1.2e8 / td_parameters.L_G;
-    double t_0 = 10.;
-    double v_0 = l_0 / t_0;
-    parameters.g = (l_0 / (v_0 * v_0)) * 274.;
-  }
-
   // Density
   td_parameters.rho_0 = 1.;
 
@@ -93,6 +86,23 @@ void set_parameters(Parameters<DIMENSION>& parameters, TitovDemoulinParameters&
   td_parameters.t_ramp = 1.0;
 }
 
+// Gravity acceleration - derived from the coronal height scale (if set), unless the input sets the gravity (to other than default_g),
+// so it has to be called after the parameters are read. The gravity in effect is written back to prm (for print_parameters()).
+void set_gravity(Parameters<DIMENSION>& parameters, TitovDemoulinParameters& td_parameters, const double default_g, ParameterHandler& prm)
+{
+  // g = ( l_0 / v^2_0 ) g
+  if ((td_parameters.L_G > NEGLIGIBLE) && (parameters.g == default_g))
+  {
+    double l_0 = 1.2e8 / td_parameters.L_G;
+    double t_0 = 10.;
+    double v_0 = l_0 / t_0;
+    parameters.g = (l_0 / (v_0 * v_0)) * 274.;
+  }
+  prm.enter_subsection("Discretization");
+  prm.set("gravity", parameters.g);
+  prm.leave_subsection();
+}
+
 int main(int argc, char *argv[])
 {
   Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv, dealii::numbers::invalid_unsigned_int);
@@ -104,6 +114,16 @@ int main(int argc, char *argv[])
     Parameters<DIMENSION> parameters;
     TitovDemoulinParameters td_parameters;
     set_parameters(parameters, td_parameters);
+    const double default_g = parameters.g;
+    // Values from the parameter file and the command line (see read_parameters() in parameters.h) override the ones set above.
+    ParameterHandler prm;
+    parameters.declare_parameters(prm);
+    td_parameters.declare_parameters(prm);
+    read_parameters(prm, argc, argv);
+    parameters.parse_parameters(prm);
+    td_parameters.parse_parameters(prm);
+    set_gravity(parameters, td_parameters, default_g, prm);
+    print_parameters(prm, parameters.output_file_prefix, mpi_communicator);
     parameters.delete_old_outputs(mpi_communicator);
 
     // Declaration of triangulation. The triangulation is not initialized here, but rather in the constructor of Parameters class.
@@ -0,0 +1,41 @@
+#include "parametersTD.h"
+
+void TitovDemoulinParameters::declare_parameters(ParameterHandler& prm) const
+{
+  prm.enter_subsection("Titov-Demoulin");
+  {
+    prm.declare_entry("plasma beta", to_string_with_precision(this->beta, 16), Patterns::Double(), "Plasma beta");
+    prm.declare_entry("density", to_string_with_precision(this->rho_0, 16), Patterns::Double(), "Density");
+    prm.declare_entry("coronal height scale", to_string_with_precision(this->L_G, 16), Patterns::Double(), "Coronal height scale (0: no stratification)");
+    prm.declare_entry("torus winding number", to_string_with_precision(this->N_t, 16), Patterns::Double(), "Torus winding number");
+    prm.declare_entry("torus major radius", to_string_with_precision(this->R, 16), Patterns::Double(), "Torus major radius");
+    prm.declare_entry("torus minor radius", to_string_with_precision(this->r, 16), Patterns::Double(), "Torus minor radius");
+    prm.declare_entry("magnetic charge separation", to_string_with_precision(this->L, 16), Patterns::Double(), "Magnetic charge separation distance");
+    prm.declare_entry("geometrical factor", to_string_with_precision(this->d, 16), Patterns::Double(), "Geometrical factor (depth of the torus center)");
+    prm.declare_entry("temperature ratio", to_string_with_precision(this->Tc2Tp, 16), Patterns::Double(), "The coronal/prominence temperature ratio");
+    prm.declare_entry("omega 0", to_string_with_precision(this->omega_0, 16), Patterns::Double(), "Maximum angular velocity of the driving");
+    prm.declare_entry("drive time", to_string_with_precision(this->t_drive, 16), Patterns::Double(), "Time of the driving");
+    prm.declare_entry("ramp time", to_string_with_precision(this->t_ramp, 16), Patterns::Double(), "Ramp-up time of the driving");
+  }
+  prm.leave_subsection();
+}
+
+void TitovDemoulinParameters::parse_parameters(ParameterHandler& prm)
+{
+  prm.enter_subsection("Titov-Demoulin");
+  {
+    this->beta = prm.get_double("plasma beta");
+    this->rho_0 = prm.get_double("density");
+    this->L_G = prm.get_double("coronal height scale");
+    this->N_t = prm.get_double("torus winding number");
+    this->R = prm.get_double("torus major radius");
+    this->r = prm.get_double("torus minor radius");
+    this->L = prm.get_double("magnetic charge separation");
+    this->d = prm.get_double("geometrical factor");
+    this->Tc2Tp = prm.get_double("temperature ratio");
+    this->omega_0 = prm.get_double("omega 0");
+    this->t_drive = prm.get_double("drive time");
+    this->t_ramp = prm.get_double("ramp time");
+  }
+  prm.leave_subsection();
+}
@@ -1,8 +1,15 @@
 #ifndef _PARAMETERS_TD_H
 #define _PARAMETERS_TD_H
 
+#include "util.h"
+
 struct TitovDemoulinParameters
 {
+  // Declares the parameters in the section "Titov-Demoulin" of prm, with the current values as defaults.
+  void declare_parameters(ParameterHandler& prm) const;
+  // Reads the values of the parameters declared by declare_parameters().
+  void parse_parameters(ParameterHandler& prm);
+
   // plasma beta
   double beta;
 
@@ -1,4 +1,5 @@
 #include "feDivFree.h"
+#include "feTransferMatrices.h"
 
 #define DEGREE 1
 
@@ -21,13 +22,11 @@ FE_DG_DivFree<dim, spacedim>::FE_DG_DivFree()
   this->system_to_component_table[7] = std::pair<unsigned int, unsigned int>(2, 7);
   this->system_to_component_table[8] = std::pair<unsigned int, unsigned int>(2, 8);
   this->reinit_restriction_and_prolongation_matrices();
-  // Fill prolongation matrices with embedding operators
+  // Exact embedding and L2-projection in the scaled coordinates (the unit-cell shape functions are not available for the generic FETools ones).
+  // The functions 9 and 10 depend on the aspect ratio of the cell, the matrices are exact for cubes (and isotropic refinement of cubes) only,
+  // hence no anisotropic refinement and no adaptivity on non-cubic coarse cells with this element (see Problem::Problem(), Problem::set_adaptivity()).
   if (dim == spacedim)
-  {
-    FETools::compute_embedding_matrices(*this, this->prolongation);
-    // Fill restriction matrices with L2-projection
-    FETools::compute_projection_matrices(*this, this->restriction);
-  }
+    compute_scaled_transfer_matrices<dim>(*this, DEGREE + 1, this->prolongation, this->restriction);
 }
 
 
@@ -114,10 +113,22 @@ double FE_DG_DivFree<dim, spacedim>::shape_value_component(const typename Triang
 }
 
 
+template <int dim, int spacedim>
+double
+FE_DG_DivFree<dim, spacedim>::scaled_shape_value(const unsigned int i, const Point<dim> &p, const unsigned int component) const
+{
+  Point<dim> h;
+  for (unsigned int d = 0; d < dim; ++d)
+    h[d] = 1.;
+  return scaled_shape_value(i, p, component, h);
+}
+
+
 template <int dim, int spacedim>
 inline double
-FE_DG_DivFree<dim, spacedim>::shape_value_component(const typename Triangulation<dim, spacedim>::cell_iterator & cell, const unsigned int i, const Point<dim> &p, const unsigned int component, double cell_diameter) const
+FE_DG_DivFree<dim, spacedim>::scaled_shape_value(const unsigned int i, const Point<dim> &p, const unsigned int component, const Point<dim> &h) const
 {
+  // p is scaled by the extents h per direction - the functions 9 and 10 use the x-extent for both components, to stay divergence-free on anisotropic cells.
   Assert(i < this->dofs_per_cell, ExcIndexRange(i, 0, this->dofs_per_cell));
   switch (i) {
   case 0:
@@ -189,7 +200,7 @@ FE_DG_DivFree<dim, spacedim>::shape_value_component(const typename Triangulation
       return p(0);
       break;
     case 1:
-      return -p(1);
+      return -p(1) * h(1) / h(0);
       break;
     }
   case 10:
@@ -198,7 +209,7 @@ FE_DG_DivFree<dim, spacedim>::shape_value_component(const typename Triangulation
       return p(0);
       break;
     case 2:
-      return -p(2);
+      return -p(2) * h(2) / h(0);
       break;
     }
     break;
@@ -235,72 +246,78 @@ FE_DG_DivFree<dim, spacedim>::shape_grad_component(const unsigned int i, const P
 
 
 template <int dim, int spacedim>
-inline Tensor<1, dim>
+Tensor<1, dim>
 FE_DG_DivFree<dim, spacedim>::shape_grad_component(const typename Triangulation<dim, spacedim>::cell_iterator & cell, const unsigned int i, const Point<dim> &p, const unsigned int component) const
 {
-  // TODO: Use extent_in_direction() & mapping instead of diameter()
-  const double h = cell->diameter();
+  return shape_grad_component(cell, i, p, component, cell_extents<dim>(cell));
+}
+
+
+template <int dim, int spacedim>
+inline Tensor<1, dim>
+FE_DG_DivFree<dim, spacedim>::shape_grad_component(const typename Triangulation<dim, spacedim>::cell_iterator & cell, const unsigned int i, const Point<dim> &p, const unsigned int component, const Point<dim> &h) const
+{
   Tensor<1, dim> grad({ 0., 0., 0. });
   switch (i) {
   case 3:
     switch (component) {
     case 0:
-      grad[1] = 1. / h;
+      grad[1] = 1. / h[1];
       break;
     }
     break;
   case 4:
     switch (component) {
     case 0:
-      grad[2] = 1. / h;
+      grad[2] = 1. / h[2];
       break;
     }
     break;
   case 5:
     switch (component) {
     case 1:
-      grad[0] = 1. / h;
+      grad[0] = 1. / h[0];
       break;
     }
     break;
   case 6:
     switch (component) {
     case 1:
-      grad[2] = 1. / h;
+      grad[2] = 1. / h[2];
       break;
     }
     break;
   case 7:
     switch (component) {
     case 2:
-      grad[0] = 1. / h;
+      grad[0] = 1. / h[0];
       break;
     }
     break;
   case 8:
     switch (component) {
     case 2:
-      grad[1] = 1. / h;
+      grad[1] = 1. / h[1];
       break;
     }
     break;
   case 9:
     switch (component) {
     case 0:
-      grad[0] = 1. / h;
+      grad[0] = 1. / h[0];
       break;
     case 1:
-      grad[1] = -1. / h;
+      grad[1] = -1. / h[0];
       break;
     }
     break;
   case 10:
     switch (component) {
     case 0:
-      grad[0] = 1. / h;
+      grad[0] = 1. / h[0];
       break;
     case 2:
-      grad[2] = -1. / h;
+      grad[2] = -1. / h[0];
       break;
     }
     break;
@@ -361,13 +378,14 @@ FE_DG_DivFree<dim, spacedim>::fill_fe_values(const typename Triangulation<dim, s
   Assert(fe_internal.update_each & update_quadrature_points, ExcInternalError());
 
   const unsigned int n_q_points = mapping_data.quadrature_points.size();
-  double h = cell->diameter();
+  const Point<dim> h = cell_extents<dim>(cell);
   Point<dim> c = cell->center();
 
   for (unsigned int i = 0; i < n_q_points; ++i)
   {
-    // TODO: Use extent_in_direction() & mapping instead of diameter()
-    const Point<dim> p = (Point<dim>) (mapping_data.quadrature_points[i] - c) / h;
+    Point<dim> p;
+    for (unsigned int d = 0; d < dim; ++d)
+      p[d] = (mapping_data.quadrature_points[i][d] - c[d]) / h[d];
 
     // Array size is dofs_per_cell * n_components
     for (unsigned int k = 0; k < this->dofs_per_cell; ++k)
@@ -377,9 +395,9 @@ FE_DG_DivFree<dim, spacedim>::fill_fe_values(const typename Triangulation<dim, s
         if (output_data.shape_function_to_row_table[k * dim + j] != numbers::invalid_unsigned_int)
         {
           if (fe_internal.update_each & update_values)
-            output_data.shape_values[output_data.shape_function_to_row_table[k * dim + j]][i] = this->shape_value_component(cell, k, p, j, h);
+            output_data.shape_values[output_data.shape_function_to_row_table[k * dim + j]][i] = this->scaled_shape_value(k, p, j, h);
           if (fe_internal.update_each & update_gradients)
-            output_data.shape_gradients[output_data.shape_function_to_row_table[k * dim + j]][i] = this->shape_grad_component(cell, k, p, j);
+            output_data.shape_gradients[output_data.shape_function_to_row_table[k * dim + j]][i] = this->shape_grad_component(cell, k, p, j, h);
         }
       }
     }
@@ -401,13 +419,14 @@ FE_DG_DivFree<dim, spacedim>::fill_fe_face_values(const typename Triangulation<d
   Assert(fe_internal.update_each & update_quadrature_points, ExcInternalError());
 
   const unsigned int n_q_points = mapping_data.quadrature_points.size();
-  double h = cell->diameter();
+  const Point<dim> h = cell_extents<dim>(cell);
   Point<dim> c = cell->center();
 
   for (unsigned int i = 0; i < n_q_points; ++i)
   {
-    // TODO: Use extent_in_direction() & mapping instead of diameter()
-    const Point<dim> p = (Point<dim>) (mapping_data.quadrature_points[i] - c) / h;
+    Point<dim> p;
+    for (unsigned int d = 0; d < dim; ++d)
+      p[d] = (mapping_data.quadrature_points[i][d] - c[d]) / h[d];
 
     // Array size is dofs_per_cell * n_components
     for (unsigned int k = 0; k < this->dofs_per_cell; ++k)
@@ -417,9 +436,9 @@ FE_DG_DivFree<dim, spacedim>::fill_fe_face_values(const typename Triangulation<d
         if (output_data.shape_function_to_row_table[k * dim + j] != numbers::invalid_unsigned_int)
         {
           if (fe_internal.update_each & update_values)
-            output_data.shape_values[output_data.shape_function_to_row_table[k * dim + j]][i] = this->shape_value_component(cell, k, p, j, h);
+            output_data.shape_values[output_data.shape_function_to_row_table[k * dim + j]][i] = this->scaled_shape_value(k, p, j, h);
           if (fe_internal.update_each & update_gradients)
-            output_data.shape_gradients[output_data.shape_function_to_row_table[k * dim + j]][i] = this->shape_grad_component(cell, k, p, j);
+            output_data.shape_gradients[output_data.shape_function_to_row_table[k * dim + j]][i] = this->shape_grad_component(cell, k, p, j, h);
         }
       }
     }
@@ -440,13 +459,14 @@ void FE_DG_DivFree<dim, spacedim>::fill_fe_subface_values(const typename Triangu
   Assert(fe_internal.update_each & update_quadrature_points, ExcInternalError());
 
   const unsigned int n_q_points = mapping_data.quadrature_points.size();
-  double h = cell->diameter();
+  const Point<dim> h = cell_extents<dim>(cell);
   Point<dim> c = cell->center();
 
   for (unsigned int i = 0; i < n_q_points; ++i)
   {
-    // TODO: Use extent_in_direction() & mapping instead of diameter()
-    const Point<dim> p = (Point<dim>) (mapping_data.quadrature_points[i] - c) / h;
+    Point<dim> p;
+    for (unsigned int d = 0; d < dim; ++d)
+      p[d] = (mapping_data.quadrature_points[i][d] - c[d]) / h[d];
 
     // Array size is dofs_per_cell * n_components
     for (unsigned int k = 0; k < this->dofs_per_cell; ++k)
@@ -456,9 +476,9 @@ void FE_DG_DivFree<dim, spacedim>::fill_fe_subface_values(const typename Triangu
         if (output_data.shape_function_to_row_table[k * dim + j] != numbers::invalid_unsigned_int)
         {
           if (fe_internal.update_each & update_values)
-            output_data.shape_values[output_data.shape_function_to_row_table[k * dim + j]][i] = this->shape_value_component(cell, k, p, j, h);
+            output_data.shape_values[output_data.shape_function_to_row_table[k * dim + j]][i] = this->scaled_shape_value(k, p, j, h);
           if (fe_internal.update_each & update_gradients)
-            output_data.shape_gradients[output_data.shape_function_to_row_table[k * dim + j]][i] = this->shape_grad_component(cell, k, p, j);
+            output_data.shape_gradients[output_data.shape_function_to_row_table[k * dim + j]][i] = this->shape_grad_component(cell, k, p, j, h);
         }
       }
     }
@@ -97,11 +97,17 @@ public:
     const Point<dim> &p,
     const unsigned int component) const;
 
-  double shape_value_component
-  (const typename Triangulation<dim, spacedim>::cell_iterator & cell,
-    const unsigned int i,
+  // Value of the component of the i-th shape function at the point p scaled by the cell extents h (relative to the cell center).
+  double scaled_shape_value
+  (const unsigned int i,
     const Point<dim> &p,
-    const unsigned int component, double cell_diameter) const;
+    const unsigned int component, const Point<dim> &h) const;
+
+  // The same on a cube (used for the grid transfer matrices, see compute_scaled_transfer_matrices()).
+  double scaled_shape_value
+  (const unsigned int i,
+    const Point<dim> &p,
+    const unsigned int component) const;
 
   /**
   * Return the gradient of the
@@ -177,6 +183,14 @@ public:
     const Point<dim> &p,
     const unsigned int component) const;
 
+  // The same, with the cell extents (by which the shape functions are scaled) given.
+  Tensor<1, dim> shape_grad_component
+  (const typename Triangulation<dim, spacedim>::cell_iterator & cell,
+    const unsigned int i,
+    const Point<dim> &p,
+    const unsigned int component,
+    const Point<dim> &h) const;
+
   /**
   * X Return the tensor of second
   * X derivatives of the @p ith
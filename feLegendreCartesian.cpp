@@ -0,0 +1,26 @@
+#include "feLegendreCartesian.h"
+
+template <int dim, int spacedim>
+FE_DG_LegendreCartesian<dim, spacedim>::FE_DG_LegendreCartesian(const unsigned int degree)
+  :
+  FE_DG_Taylor<dim, spacedim>(degree, Polynomials::Legendre::generate_complete_basis(degree), 0.5)
+{
+}
+
+
+template <int dim, int spacedim>
+std::string FE_DG_LegendreCartesian<dim, spacedim>::get_name() const
+{
+  std::ostringstream namebuf;
+  namebuf << "FE_DG_LegendreCartesian<" << Utilities::dim_string(dim, spacedim) << ">(" << this->degree << ")";
+  return namebuf.str();
+}
+
+
+template <int dim, int spacedim>
+FiniteElement<dim, spacedim> * FE_DG_LegendreCartesian<dim, spacedim>::clone() const
+{
+  return new FE_DG_LegendreCartesian<dim, spacedim>(*this);
+}
+
+template class FE_DG_LegendreCartesian<3>;
@@ -0,0 +1,26 @@
+#ifndef _FE_LEGENDRE_CARTESIAN_H
+#define _FE_LEGENDRE_CARTESIAN_H
+
+#include "feTaylor.h"
+
+/**
+* Discontinuous finite elements of the complete space of the products of Legendre polynomials,
+* evaluated like FE_DG_Taylor at <tt> ( point - cell->center() ) / h </tt> (componentwise, h being the cell extents),
+* shifted to the interval [0, 1] of the polynomials.
+*
+* On Cartesian (axis-aligned box) cells, the basis is orthogonal - the mass matrix is diagonal, and the first
+* (constant) basis function carries the cell mean, all other ones having zero mean.
+*/
+template <int dim, int spacedim = dim>
+class FE_DG_LegendreCartesian : public FE_DG_Taylor<dim, spacedim>
+{
+public:
+  FE_DG_LegendreCartesian(const unsigned int k);
+
+  virtual std::string get_name() const;
+
+protected:
+  virtual FiniteElement<dim, spacedim> *clone() const;
+};
+
+#endif
@@ -14,9 +14,18 @@
 // ---------------------------------------------------------------------
 
 #include "feTaylor.h"
+#include "feTransferMatrices.h"
 
 template <int dim, int spacedim>
 FE_DG_Taylor<dim, spacedim>::FE_DG_Taylor(const unsigned int degree)
+  :
+  FE_DG_Taylor<dim, spacedim>(degree, Polynomials::Monomial<double>::generate_complete_basis(degree), 0.)
+{
+}
+
+
+template <int dim, int spacedim>
+FE_DG_Taylor<dim, spacedim>::FE_DG_Taylor(const unsigned int degree, const std::vector<Polynomials::Polynomial<double> >& polynomials, const double point_shift)
   :
   FiniteElement<dim, spacedim>(
     FiniteElementData<dim>(get_dpo_vector(degree), 1, degree,
@@ -26,16 +35,39 @@ FE_DG_Taylor<dim, spacedim>::FE_DG_Taylor(const unsigned int degree)
     std::vector<ComponentMask>(
       FiniteElementData<dim>(get_dpo_vector(degree), 1, degree).dofs_per_cell,
       std::vector<bool>(1, true))), FiniteElementIsConstantInterface<dim>(),
-  polynomial_space(Polynomials::Monomial<double>::generate_complete_basis(degree))
+  polynomial_space(polynomials),
+  point_shift(point_shift)
 {
-  this->reinit_restriction_and_prolongation_matrices();
-  // Fill prolongation matrices with embedding operators
-  if (dim == spacedim)
+  // Means of the monomials over the cell in the scaled coordinates, subtracted from the non-constant ones, so that the constant coefficient is the cell mean
+  // (which the limiters and the P0 reduction rely on) - all of them are zero up to degree 1.
+  basis_means.assign(this->dofs_per_cell, 0.);
+  if (degree > 1)
   {
-    FETools::compute_embedding_matrices(*this, this->prolongation);
-    // Fill restriction matrices with L2-projection
-    FETools::compute_projection_matrices(*this, this->restriction);
+    const QGauss<dim> quadrature(degree + 1);
+    for (unsigned int q = 0; q < quadrature.size(); ++q)
+    {
+      Point<dim> p = quadrature.point(q);
+      for (unsigned int d = 0; d < dim; ++d)
+        p[d] += point_shift - 0.5;
+      for (unsigned int i = 1; i < this->dofs_per_cell; ++i)
+        basis_means[i] += quadrature.weight(q) * polynomial_space.compute_value(i, p);
+    }
   }
+
+  this->reinit_restriction_and_prolongation_matrices();
+  // Exact embedding and L2-projection in the scaled coordinates (the unit-cell shape functions are not available for the generic FETools ones).
+  if (dim == spacedim)
+    compute_scaled_transfer_matrices<dim>(*this, degree + 1, this->prolongation, this->restriction);
+}
+
+
+template <int dim, int spacedim>
+double FE_DG_Taylor<dim, spacedim>::scaled_shape_value(const unsigned int i, const Point<dim> &p, const unsigned int component) const
+{
+  Point<dim> shifted_p = p;
+  for (unsigned int d = 0; d < dim; ++d)
+    shifted_p[d] += point_shift;
+  return polynomial_space.compute_value(i, shifted_p) - basis_means[i];
 }
 
 template <int dim, int spacedim>
@@ -225,28 +257,33 @@ FE_DG_Taylor<dim, spacedim>::fill_fe_values(const typename Triangulation<dim, sp
   std::vector<Tensor<3, dim> > empty_vector_of_3rd_order_tensors;//not used here, as well as elsewhere. not added everywhere!
   std::vector<Tensor<4, dim> > empty_vector_of_4th_order_tensors; //same as above and not well implemented in deal
 
-  double h = cell->diameter();
+  const Point<dim> h = cell_extents<dim>(cell);
   Point<dim> c = cell->center();
 
   if (fe_internal.update_each & (update_values | update_gradients))
     for (unsigned int i = 0; i < n_q_points; ++i)
     {
-      const Point<dim> p = (Point<dim>)(mapping_data.quadrature_points[i] - c) / h;
+      Point<dim> p;
+      for (unsigned int d = 0; d < dim; ++d)
+        p[d] = (mapping_data.quadrature_points[i][d] - c[d]) / h[d] + point_shift;
       polynomial_space.compute(p, //mapping_data.quadrature_points[i],
         values, grads, grad_grads,
         empty_vector_of_3rd_order_tensors,
         empty_vector_of_4th_order_tensors);
       if (fe_internal.update_each & update_values)
         for (unsigned int k = 0; k < this->dofs_per_cell; ++k)
-          output_data.shape_values[k][i] = values[k];
+          output_data.shape_values[k][i] = values[k] - basis_means[k];
 
       if (fe_internal.update_each & update_gradients)
         for (unsigned int k = 0; k < this->dofs_per_cell; ++k)
-          output_data.shape_gradients[k][i] = grads[k] / h;
+          for (unsigned int d = 0; d < dim; ++d)
+            output_data.shape_gradients[k][i][d] = grads[k][d] / h[d];
 
       if (fe_internal.update_each & update_hessians)
         for (unsigned int k = 0; k < this->dofs_per_cell; ++k)
-          output_data.shape_hessians[k][i] = grad_grads[k] / h / h;
+          for (unsigned int d = 0; d < dim; ++d)
+            for (unsigned int e = 0; e < dim; ++e)
+              output_data.shape_hessians[k][i][d][e] = grad_grads[k][d][e] / (h[d] * h[e]);
     }
 }
 
@@ -272,29 +309,34 @@ FE_DG_Taylor<dim, spacedim>::fill_fe_face_values(const typename Triangulation<di
   std::vector<Tensor<3, dim> > empty_vector_of_3rd_order_tensors;
   std::vector<Tensor<4, dim> > empty_vector_of_4th_order_tensors;
 
-  double h = cell->diameter();
+  const Point<dim> h = cell_extents<dim>(cell);
   Point<dim> c = cell->center();
 
   if (fe_internal.update_each & (update_values | update_gradients))
   {
     for (unsigned int i = 0; i < n_q_points; ++i)
     {
-      const Point<dim> p = (Point<dim>) (mapping_data.quadrature_points[i] - c) / h;
+      Point<dim> p;
+      for (unsigned int d = 0; d < dim; ++d)
+        p[d] = (mapping_data.quadrature_points[i][d] - c[d]) / h[d] + point_shift;
       polynomial_space.compute(p, //mapping_data.quadrature_points[i],
         values, grads, grad_grads,
         empty_vector_of_3rd_order_tensors,
         empty_vector_of_4th_order_tensors);
       if (fe_internal.update_each & update_values)
         for (unsigned int k = 0; k < this->dofs_per_cell; ++k)
-          output_data.shape_values[k][i] = values[k];
+          output_data.shape_values[k][i] = values[k] - basis_means[k];
 
       if (fe_internal.update_each & update_gradients)
         for (unsigned int k = 0; k < this->dofs_per_cell; ++k)
-          output_data.shape_gradients[k][i] = grads[k] / h;
+          for (unsigned int d = 0; d < dim; ++d)
+            output_data.shape_gradients[k][i][d] = grads[k][d] / h[d];
 
       if (fe_internal.update_each & update_hessians)
         for (unsigned int k = 0; k < this->dofs_per_cell; ++k)
-          output_data.shape_hessians[k][i] = grad_grads[k] / h / h;
+          for (unsigned int d = 0; d < dim; ++d)
+            for (unsigned int e = 0; e < dim; ++e)
+              output_data.shape_hessians[k][i][d][e] = grad_grads[k][d][e] / (h[d] * h[e]);
     }
   }
 }
@@ -321,28 +363,33 @@ void FE_DG_Taylor<dim, spacedim>::fill_fe_subface_values(const typename Triangul
   std::vector<Tensor<3, dim> > empty_vector_of_3rd_order_tensors;
   std::vector<Tensor<4, dim> > empty_vector_of_4th_order_tensors;
 
-  double h = cell->diameter();
+  const Point<dim> h = cell_extents<dim>(cell);
   Point<dim> c = cell->center();
 
   if (fe_internal.update_each & (update_values | update_gradients))
     for (unsigned int i = 0; i < n_q_points; ++i)
     {
-      const Point<dim> p = (Point<dim>)(mapping_data.quadrature_points[i] - c) / h;
+      Point<dim> p;
+      for (unsigned int d = 0; d < dim; ++d)
+        p[d] = (mapping_data.quadrature_points[i][d] - c[d]) / h[d] + point_shift;
       polynomial_space.compute(p, //mapping_data.quadrature_points[i],
         values, grads, grad_grads,
         empty_vector_of_3rd_order_tensors,
         empty_vector_of_4th_order_tensors);
       if (fe_internal.update_each & update_values)
         for (unsigned int k = 0; k < this->dofs_per_cell; ++k)
-          output_data.shape_values[k][i] = values[k];
+          output_data.shape_values[k][i] = values[k] - basis_means[k];
 
       if (fe_internal.update_each & update_gradients)
         for (unsigned int k = 0; k < this->dofs_per_cell; ++k)
-          output_data.shape_gradients[k][i] = grads[k] / h;
+          for (unsigned int d = 0; d < dim; ++d)
+            output_data.shape_gradients[k][i][d] = grads[k][d] / h[d];
 
       if (fe_internal.update_each & update_hessians)
         for (unsigned int k = 0; k < this->dofs_per_cell; ++k)
-          output_data.shape_hessians[k][i] = grad_grads[k] / h / h;
+          for (unsigned int d = 0; d < dim; ++d)
+            for (unsigned int e = 0; e < dim; ++e)
+              output_data.shape_hessians[k][i][d][e] = grad_grads[k][d][e] / (h[d] * h[e]);
     }
 }
 
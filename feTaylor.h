@@ -1,3 +1,6 @@
+#ifndef _FE_TAYLOR_H
+#define _FE_TAYLOR_H
+
 #include "util.h"
 #include "feIsConstInterface.h"
 
@@ -16,8 +19,9 @@
 * linear, quadratic, etc. on any grid cell.
 *
 * Since the polynomials are evaluated at the quadrature points of the
-* actual grid cell, no grid transfer and interpolation matrices are
-* available.
+* actual grid cell, no interpolation matrices are available. The grid
+* transfer matrices are computed in the scaled coordinates, where they
+* do not depend on the cell.
 *
 * The purpose of this class is experimental, therefore the
 * implementation will remain incomplete.
@@ -27,7 +31,10 @@
 *
 * This is derived from FE_DGPNonparametric written by Guido Kanschat but using Monomial
 * instead of Legendre, and including a shift and scaling. The monomials are evaluated at
-*                 <tt> ( point - cell->center() ) / cell->diameter() </tt>
+*                 <tt> ( point - cell->center() ) / h </tt>, componentwise,
+* where h are the extents of the cell in the coordinate directions (so anisotropic cells are handled).
+* The non-constant monomials have their cell mean subtracted (which only changes those of degree 2 and higher),
+* so that the coefficient of the constant is the cell mean.
 *
 * @author Praveen. C, 2013
 */
@@ -60,6 +67,9 @@ public:
 
   bool is_constant(const unsigned int i) const;
 
+  // Value of the i-th shape function at the point p scaled by the cell extents (relative to the cell center), see compute_scaled_transfer_matrices().
+  double scaled_shape_value(const unsigned int i, const Point<dim> &p, const unsigned int component) const;
+
   /**
    * Return the value of the
    * @p ith shape function at the
@@ -469,6 +479,13 @@ public:
   virtual std::size_t memory_consumption () const;
 
 protected:
+  /**
+   * Constructor for the complete space of the
+   * @p polynomials (of degree @p k), evaluated at the
+   * scaled coordinates shifted by @p point_shift.
+   */
+  FE_DG_Taylor (const unsigned int k, const std::vector<Polynomials::Polynomial<double> >& polynomials, const double point_shift);
+
 
   /**
    * @p clone function instead of
@@ -549,6 +566,19 @@ private:
    */
   const PolynomialSpace<dim> polynomial_space;
 
+  /**
+   * Means of the polynomials over the
+   * cell, subtracted from the shape
+   * functions (except the constant one).
+   */
+  std::vector<double> basis_means;
+
+  /**
+   * Added to the scaled coordinates
+   * before the polynomials are evaluated.
+   */
+  const double point_shift;
+
 
   /**
    * Allow access from other dimensions.
@@ -561,4 +591,6 @@ private:
    * function.
    */
   template <int, int> friend class MappingQ;//coud be removed
-};
\ No newline at end of file
+};
+
+#endif
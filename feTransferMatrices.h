@@ -0,0 +1,68 @@
+#ifndef _FE_TRANSFER_MATRICES_H
+#define _FE_TRANSFER_MATRICES_H
+
+#include "util.h"
+
+// Grid transfer matrices of the DG elements whose shape functions are polynomials of the scaled coordinates p = (x - c) / h of an (axis-aligned) cell
+// with the center c and the extents h - in these coordinates, a child cell is a fixed affine image of the parent, whatever the cell size, so the matrices
+// are the same for all cells and are precomputed here once, for all refinement cases.
+// - prolongation: the parent function is contained in the child space, so the embedding is exact (M_child^-1 B),
+// - restriction: L2-projection of the child functions to the parent (M_parent^-1 B^T |child| / |parent|), additive over the children.
+// Both are conservative for cell means, because the constants are in the spaces.
+// The element provides scaled_shape_value(i, p, component), the value of the i-th shape function at the scaled point p (in [-1/2, 1/2]^dim).
+// The quadrature of n_q_points_1d Gauss points integrates the products of the shape functions exactly if n_q_points_1d > degree.
+template <int dim, typename Element>
+void compute_scaled_transfer_matrices(const Element& fe, const unsigned int n_q_points_1d, std::vector<std::vector<FullMatrix<double> > >& prolongation, std::vector<std::vector<FullMatrix<double> > >& restriction)
+{
+  const unsigned int n = fe.dofs_per_cell, n_components = fe.n_components();
+  const QGauss<dim> quadrature(n_q_points_1d);
+  const unsigned int n_q_points = quadrature.size();
+
+  // Shape function values in the quadrature points - mapped to the whole cell (child or parent), and in the parent coordinates of a child.
+  std::vector<std::vector<double> > values(n_q_points, std::vector<double>(n * n_components)), parent_values(n_q_points, std::vector<double>(n * n_components));
+  Point<dim> center;
+  for (unsigned int d = 0; d < dim; ++d)
+    center[d] = 0.5;
+  for (unsigned int q = 0; q < n_q_points; ++q)
+    for (unsigned int i = 0; i < n; ++i)
+      for (unsigned int c = 0; c < n_components; ++c)
+        values[q][i * n_components + c] = fe.scaled_shape_value(i, (Point<dim>)(quadrature.point(q) - center), c);
+
+  // The mass matrix is the same for the parent and the children, up to the volume.
+  FullMatrix<double> mass_matrix(n, n), inverse_mass_matrix(n, n), child_parent_matrix(n, n);
+  for (unsigned int i = 0; i < n; ++i)
+    for (unsigned int j = 0; j < n; ++j)
+      for (unsigned int q = 0; q < n_q_points; ++q)
+        for (unsigned int c = 0; c < n_components; ++c)
+          mass_matrix(i, j) += quadrature.weight(q) * values[q][i * n_components + c] * values[q][j * n_components + c];
+  inverse_mass_matrix.invert(mass_matrix);
+
+  for (unsigned int ref_case = RefinementCase<dim>::cut_x; ref_case <= RefinementCase<dim>::isotropic_refinement; ++ref_case)
+  {
+    const unsigned int n_children = GeometryInfo<dim>::n_children(RefinementCase<dim>(ref_case));
+    for (unsigned int child = 0; child < n_children; ++child)
+    {
+      for (unsigned int q = 0; q < n_q_points; ++q)
+      {
+        const Point<dim> parent_point = GeometryInfo<dim>::child_to_cell_coordinates(quadrature.point(q), child, RefinementCase<dim>(ref_case));
+        for (unsigned int j = 0; j < n; ++j)
+          for (unsigned int c = 0; c < n_components; ++c)
+            parent_values[q][j * n_components + c] = fe.scaled_shape_value(j, (Point<dim>)(parent_point - center), c);
+      }
+
+      // Integrals of the child shape functions times the parent ones over the child (in the child reference coordinates).
+      child_parent_matrix = 0.;
+      for (unsigned int i = 0; i < n; ++i)
+        for (unsigned int j = 0; j < n; ++j)
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            for (unsigned int c = 0; c < n_components; ++c)
+              child_parent_matrix(i, j) += quadrature.weight(q) * values[q][i * n_components + c] * parent_values[q][j * n_components + c];
+
+      inverse_mass_matrix.mmult(prolongation[ref_case - 1][child], child_parent_matrix);
+      inverse_mass_matrix.mTmult(restriction[ref_case - 1][child], child_parent_matrix);
+      restriction[ref_case - 1][child] *= 1. / n_children;
+    }
+  }
+}
+
+#endif
@@ -1,9 +1,10 @@
 #include "numericalFlux.h"
 
 template <EquationsType equationsType, int dim>
-void NumFlux<equationsType, dim>::Q(n_comp_array &result, const n_comp_array &W, const Tensor<1, dim> &normal)
+template <typename Number>
+void NumFlux<equationsType, dim>::Q(std::array<Number, n_comp> &result, const std::array<Number, n_comp> &W, const Tensor<1, dim> &normal)
 {
-  double forResult[n_comp];
+  Number forResult[n_comp];
   for (unsigned int d = 0; d < n_comp; d++)
     forResult[d] = W[d];
   if (normal[0] > 0.5) { // nothing
@@ -44,9 +45,10 @@ void NumFlux<equationsType, dim>::Q(n_comp_array &result, const n_comp_array &W,
 }
 
 template <EquationsType equationsType, int dim>
-void NumFlux<equationsType, dim>::Q_inv(n_comp_array &result, n_comp_array &W, const Tensor<1, dim> &normal)
+template <typename Number>
+void NumFlux<equationsType, dim>::Q_inv(std::array<Number, n_comp> &result, std::array<Number, n_comp> &W, const Tensor<1, dim> &normal)
 {
-  double forResult[n_comp];
+  Number forResult[n_comp];
   for (unsigned int d = 0; d < n_comp; d++)
     forResult[d] = W[d];
   if (normal[0] > 0.5) { // nothing
@@ -89,36 +91,52 @@ template <EquationsType equationsType, int dim>
 void NumFluxLaxFriedrich<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim> &normal, const n_comp_array &Wplus_,
   const n_comp_array &Wminus_, n_comp_array &normal_flux, double& max_speed) const
 {
-  double hl[2], hr[2], spd[5];
+  compute_numerical_normal_flux(normal, Wplus_, Wminus_, normal_flux, max_speed);
+}
+
+template <EquationsType equationsType, int dim>
+void NumFluxLaxFriedrich<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim> &normal, const n_comp_array_float &Wplus_,
+  const n_comp_array_float &Wminus_, n_comp_array_float &normal_flux, double& max_speed) const
+{
+  compute_numerical_normal_flux(normal, Wplus_, Wminus_, normal_flux, max_speed);
+}
+
+template <EquationsType equationsType, int dim>
+template <typename Number>
+void NumFluxLaxFriedrich<equationsType, dim>::compute_numerical_normal_flux(const Tensor<1, dim> &normal, const std::array<Number, n_comp> &Wplus_,
+  const std::array<Number, n_comp> &Wminus_, std::array<Number, n_comp> &normal_flux, double& max_speed) const
+{
+  const Number gas_gamma = this->parameters.gas_gamma;
+  Number hl[2], hr[2], spd[5];
 
-  n_comp_array ul, ur;
+  std::array<Number, n_comp> ul, ur;
   this->Q(ul, Wplus_, normal);
   this->Q(ur, Wminus_, normal);
 
   // Densities, energies.
-  hl[0] = 1.0 / ul[0];
-  double Ukl = 0.5 * hl[0] * (ul[1] * ul[1] + ul[2] * ul[2] + ul[3] * ul[3]);
-  double Uml = 0.5 * (ul[5] * ul[5] + ul[6] * ul[6] + ul[7] * ul[7]);
-  hl[1] = (this->parameters.gas_gamma - 1.) * (ul[4] - Ukl - Uml);
+  hl[0] = Number(1.0) / ul[0];
+  Number Ukl = Number(0.5) * hl[0] * (ul[1] * ul[1] + ul[2] * ul[2] + ul[3] * ul[3]);
+  Number Uml = Number(0.5) * (ul[5] * ul[5] + ul[6] * ul[6] + ul[7] * ul[7]);
+  hl[1] = (gas_gamma - Number(1.)) * (ul[4] - Ukl - Uml);
 
-  hr[0] = 1.0 / ur[0];
-  double Ukr = 0.5 * hr[0] * (ur[1] * ur[1] + ur[2] * ur[2] + ur[3] * ur[3]);
-  double Umr = 0.5 * (ur[5] * ur[5] + ur[6] * ur[6] + ur[7] * ur[7]);
-  hr[1] = (this->parameters.gas_gamma - 1.) * (ur[4] - Ukr - Umr);
+  hr[0] = Number(1.0) / ur[0];
+  Number Ukr = Number(0.5) * hr[0] * (ur[1] * ur[1] + ur[2] * ur[2] + ur[3] * ur[3]);
+  Number Umr = Number(0.5) * (ur[5] * ur[5] + ur[6] * ur[6] + ur[7] * ur[7]);
+  hr[1] = (gas_gamma - Number(1.)) * (ur[4] - Ukr - Umr);
 
   // sound speed
-  double al2 = this->parameters.gas_gamma * hl[1] * hl[0];
-  double ar2 = this->parameters.gas_gamma * hr[1] * hr[0];
+  Number al2 = gas_gamma * hl[1] * hl[0];
+  Number ar2 = gas_gamma * hr[1] * hr[0];
 
   // fast magnetoacoustic speed
-  double cl = (al2 + (2. * Uml * hl[0]));
-  cl = sqrt(0.5 * (cl + sqrt((cl * cl) - (4.0 * al2 * ul[5] * ul[5] * hl[0]))));
+  Number cl = (al2 + (Number(2.) * Uml * hl[0]));
+  cl = std::sqrt(Number(0.5) * (cl + std::sqrt((cl * cl) - (Number(4.0) * al2 * ul[5] * ul[5] * hl[0]))));
 
-  double cr = ar2 + (2. * Umr * hr[0]);
-  cr = sqrt(0.5 * (cr + sqrt((cr * cr) - (4.0 * ar2 * ur[5] * ur[5] * hr[0]))));
+  Number cr = ar2 + (Number(2.) * Umr * hr[0]);
+  cr = std::sqrt(Number(0.5) * (cr + std::sqrt((cr * cr) - (Number(4.0) * ar2 * ur[5] * ur[5] * hr[0]))));
 
   // maximum of fast magnetoacoustic speeds L/R
-  double cm = (cl > cr) ? cl : cr;
+  Number cm = (cl > cr) ? cl : cr;
   if (ul[1] * hl[0] <= ur[1] * hr[0]) {
     spd[0] = ul[1] * hl[0] - cm;
     spd[4] = ur[1] * hr[0] + cm;
@@ -128,20 +146,20 @@ void NumFluxLaxFriedrich<equationsType, dim>::numerical_normal_flux(const Tensor
     spd[4] = ul[1] * hl[0] + cm;
   }
 
-  max_speed = std::max(max_speed, (std::max(std::abs(spd[0]), std::abs(spd[4]))));
+  max_speed = std::max(max_speed, (double)(std::max(std::abs(spd[0]), std::abs(spd[4]))));
 
-  std::array<std::array <double, dim>, n_comp > iflux, oflux;
+  std::array<std::array <Number, dim>, n_comp > iflux, oflux;
 
   Equations<equationsType, dim>::compute_flux_matrix(Wplus_, iflux, this->parameters);
   Equations<equationsType, dim>::compute_flux_matrix(Wminus_, oflux, this->parameters);
 
   for (unsigned int di = 0; di < n_comp; ++di)
   {
-    normal_flux[di] = 0.;
+    normal_flux[di] = Number(0.);
     for (unsigned int d = 0; d < dim; ++d)
-      normal_flux[di] += 0.5 * (iflux[di][d] + oflux[di][d]) * normal[d];
+      normal_flux[di] += Number(0.5) * (iflux[di][d] + oflux[di][d]) * Number(normal[d]);
 
-    normal_flux[di] += this->parameters.lax_friedrich_stabilization_value * (Wplus_[di] - Wminus_[di]);
+    normal_flux[di] += Number(this->parameters.lax_friedrich_stabilization_value) * (Wplus_[di] - Wminus_[di]);
   }
 }
 
@@ -149,53 +167,69 @@ template <EquationsType equationsType, int dim>
 void NumFluxHLLD<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim> &normal, const n_comp_array &Wplus_,
   const n_comp_array &Wminus_, n_comp_array &normal_flux, double& max_speed) const
 {
-  n_comp_array flux_lf;
-  if (this->parameters.debug & this->parameters.NumFlux)
+  compute_numerical_normal_flux(normal, Wplus_, Wminus_, normal_flux, max_speed);
+}
+
+template <EquationsType equationsType, int dim>
+void NumFluxHLLD<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim> &normal, const n_comp_array_float &Wplus_,
+  const n_comp_array_float &Wminus_, n_comp_array_float &normal_flux, double& max_speed) const
+{
+  compute_numerical_normal_flux(normal, Wplus_, Wminus_, normal_flux, max_speed);
+}
+
+template <EquationsType equationsType, int dim>
+template <typename Number>
+void NumFluxHLLD<equationsType, dim>::compute_numerical_normal_flux(const Tensor<1, dim> &normal, const std::array<Number, n_comp> &Wplus_,
+  const std::array<Number, n_comp> &Wminus_, std::array<Number, n_comp> &normal_flux, double& max_speed) const
+{
+  const Number gas_gamma = this->parameters.gas_gamma;
+  std::array<Number, n_comp> flux_lf;
+  if (DEBUG_FLAG_SET(this->parameters, NumFlux))
   {
     NumFluxLaxFriedrich<equationsType, dim> lf(this->parameters);
     lf.numerical_normal_flux(normal, Wplus_, Wminus_, flux_lf, max_speed);
   }
 
-  double Fl[n_comp], Fr[n_comp], hl[2], hr[2];
-  double Uldst[n_comp], Urdst[n_comp], Ulst[n_comp], Urst[n_comp];
-  double spd[5], vbstl, vbstr, Bsgn, invsumd;
+  Number Fl[n_comp], Fr[n_comp], hl[2], hr[2];
+  Number Uldst[n_comp], Urdst[n_comp], Ulst[n_comp], Urst[n_comp];
+  Number spd[5], vbstl, vbstr, Bsgn, invsumd;
 
-  n_comp_array ul, ur;
+  std::array<Number, n_comp> ul, ur;
   this->Q(ul, Wplus_, normal);
   this->Q(ur, Wminus_, normal);
 
-  double Bx = 0.5*(ul[5] + ur[5]);
+  Number Bx = Number(0.5)*(ul[5] + ur[5]);
   ul[5] = ur[5] = Bx;
-  double Bx2 = Bx * Bx;
+  Number Bx2 = Bx * Bx;
 
   // Densities, energies.
-  hl[0] = 1.0 / ul[0];
-  double Ukl = 0.5 * hl[0] * (ul[1] * ul[1] + ul[2] * ul[2] + ul[3] * ul[3]);
-  double Uml = 0.5 * (ul[5] * ul[5] + ul[6] * ul[6] + ul[7] * ul[7]);
-  hl[1] = (this->parameters.gas_gamma - 1.) * (ul[4] - Ukl - Uml);
+  hl[0] = Number(1.0) / ul[0];
+  Number Ukl = Number(0.5) * hl[0] * (ul[1] * ul[1] + ul[2] * ul[2] + ul[3] * ul[3]);
+  Number Uml = Number(0.5) * (ul[5] * ul[5] + ul[6] * ul[6] + ul[7] * ul[7]);
+  hl[1] = (gas_gamma - Number(1.)) * (ul[4] - Ukl - Uml);
 
-  hr[0] = 1.0 / ur[0];
-  double Ukr = 0.5 * hr[0] * (ur[1] * ur[1] + ur[2] * ur[2] + ur[3] * ur[3]);
-  double Umr = 0.5 * (ur[5] * ur[5] + ur[6] * ur[6] + ur[7] * ur[7]);
-  hr[1] = (this->parameters.gas_gamma - 1.) * (ur[4] - Ukr - Umr);
+  hr[0] = Number(1.0) / ur[0];
+  Number Ukr = Number(0.5) * hr[0] * (ur[1] * ur[1] + ur[2] * ur[2] + ur[3] * ur[3]);
+  Number Umr = Number(0.5) * (ur[5] * ur[5] + ur[6] * ur[6] + ur[7] * ur[7]);
+  hr[1] = (gas_gamma - Number(1.)) * (ur[4] - Ukr - Umr);
 
   // sound speed
-  double al2 = this->parameters.gas_gamma * hl[1] * hl[0];
-  double ar2 = this->parameters.gas_gamma * hr[1] * hr[0];
+  Number al2 = gas_gamma * hl[1] * hl[0];
+  Number ar2 = gas_gamma * hr[1] * hr[0];
 
   // fast magnetoacoustic speed
-  double cl = al2 + (2. * Uml * hl[0]);
-  cl = sqrt(0.5 * (cl + sqrt((cl * cl) - (4.0 * al2 * ul[5] * ul[5] * hl[0]))));
+  Number cl = al2 + (Number(2.) * Uml * hl[0]);
+  cl = std::sqrt(Number(0.5) * (cl + std::sqrt((cl * cl) - (Number(4.0) * al2 * ul[5] * ul[5] * hl[0]))));
 
-  double cr = ar2 + (2. * Umr * hr[0]);
-  cr = sqrt(0.5 * (cr + sqrt((cr * cr) - (4.0 * ar2 * ur[5] * ur[5] * hr[0]))));
+  Number cr = ar2 + (Number(2.) * Umr * hr[0]);
+  cr = std::sqrt(Number(0.5) * (cr + std::sqrt((cr * cr) - (Number(4.0) * ar2 * ur[5] * ur[5] * hr[0]))));
 
   // total pressure
-  double ptl = hl[1] + Uml;
-  double ptr = hr[1] + Umr;
+  Number ptl = hl[1] + Uml;
+  Number ptr = hr[1] + Umr;
 
   // maximum of fast magnetoacoustic speeds L/R
-  double cm = (cl > cr) ? cl : cr;
+  Number cm = (cl > cr) ? cl : cr;
   if (ul[1] * hl[0] <= ur[1] * hr[0]) {
     spd[0] = ul[1] * hl[0] - cm;
     spd[4] = ur[1] * hr[0] + cm;
@@ -205,18 +239,18 @@ void NumFluxHLLD<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim>
     spd[4] = ul[1] * hl[0] + cm;
   }
 
-  max_speed = std::max(max_speed, (std::max(std::abs(spd[0]), std::abs(spd[4]))));
+  max_speed = std::max(max_speed, (double)(std::max(std::abs(spd[0]), std::abs(spd[4]))));
 
   // Calculate left flux
-  double E2 = hl[0] * (ul[1] * ul[7] - ul[3] * ul[5]);
-  double E3 = hl[0] * (ul[2] * ul[5] - ul[1] * ul[6]);
+  Number E2 = hl[0] * (ul[1] * ul[7] - ul[3] * ul[5]);
+  Number E3 = hl[0] * (ul[2] * ul[5] - ul[1] * ul[6]);
 
   Fl[0] = ul[1];
   Fl[1] = hl[0] * ul[1] * ul[1] - ul[5] * ul[5] + ptl;
   Fl[2] = hl[0] * ul[1] * ul[2] - ul[5] * ul[6];
   Fl[3] = hl[0] * ul[1] * ul[3] - ul[5] * ul[7];
   Fl[4] = (ul[4] + ptl) * (ul[1] * hl[0]) - (ul[5] * hl[0] * (ul[1] * ul[5] + ul[2] * ul[6] + ul[3] * ul[7]));
-  Fl[5] = 0.0;
+  Fl[5] = Number(0.0);
   Fl[6] = -E3;
   Fl[7] = E2;
 
@@ -229,7 +263,7 @@ void NumFluxHLLD<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim>
   Fr[2] = hr[0] * ur[1] * ur[2] - ur[5] * ur[6];
   Fr[3] = hr[0] * ur[1] * ur[3] - ur[5] * ur[7];
   Fr[4] = (ur[4] + ptr) * (ur[1] * hr[0]) - (ur[5] * hr[0] * (ur[1] * ur[5] + ur[2] * ur[6] + ur[3] * ur[7]));
-  Fr[5] = 0.0;
+  Fr[5] = Number(0.0);
   Fr[6] = -E3;
   Fr[7] = E2;
 
@@ -237,9 +271,9 @@ void NumFluxHLLD<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim>
   if (spd[0] >= 0.0) {
     for (int j = 0; j < n_comp; j++)
       normal_flux[j] = Fl[j];
-    normal_flux[5] = 0.;
+    normal_flux[5] = Number(0.);
     this->Q_inv(normal_flux, normal_flux, normal);
-    if (this->parameters.debug & this->parameters.NumFlux)
+    if (DEBUG_FLAG_SET(this->parameters, NumFlux))
       for (int j = 0; j < n_comp; j++)
       {
         if ((std::abs(flux_lf[j]) > 1e-10) && (std::abs(normal_flux[j]) > 1e-10))
@@ -251,9 +285,9 @@ void NumFluxHLLD<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim>
   if (spd[4] <= 0.0) {
     for (int j = 0; j < n_comp; j++)
       normal_flux[j] = Fr[j];
-    normal_flux[5] = 0.;
+    normal_flux[5] = Number(0.);
     this->Q_inv(normal_flux, normal_flux, normal);
-    if (this->parameters.debug & this->parameters.NumFlux)
+    if (DEBUG_FLAG_SET(this->parameters, NumFlux))
       for (int j = 0; j < n_comp; j++)
       {
         if ((std::abs(flux_lf[j]) > 1e-10) && (std::abs(normal_flux[j]) > 1e-10))
@@ -264,29 +298,29 @@ void NumFluxHLLD<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim>
   }
 
   // Determine Alfven and middle speeds
-  double sdl = spd[0] - ul[1] * hl[0];
-  double sdr = spd[4] - ur[1] * hr[0];
+  Number sdl = spd[0] - ul[1] * hl[0];
+  Number sdr = spd[4] - ur[1] * hr[0];
   spd[2] = (ur[1] * sdr - ul[1] * sdl - ptr + ptl) / (ur[0] * sdr - ul[0] * sdl);
-  double sdml = spd[0] - spd[2];
-  double sdmr = spd[4] - spd[2];
+  Number sdml = spd[0] - spd[2];
+  Number sdmr = spd[4] - spd[2];
 
   Ulst[0] = ul[0] * sdl / sdml;
   Urst[0] = ur[0] * sdr / sdmr;
 
-  double sqrtdl = sqrt(Ulst[0]);
-  double sqrtdr = sqrt(Urst[0]);
+  Number sqrtdl = std::sqrt(Ulst[0]);
+  Number sqrtdr = std::sqrt(Urst[0]);
 
   // Sl*, Sr*
-  spd[1] = spd[2] - fabs(ul[5]) / sqrtdl;
-  spd[3] = spd[2] + fabs(ur[5]) / sqrtdr;
+  spd[1] = spd[2] - std::abs(ul[5]) / sqrtdl;
+  spd[3] = spd[2] + std::abs(ur[5]) / sqrtdr;
 
-  double ptst = ptl + ul[0] * sdl * (sdl - sdml);
+  Number ptst = ptl + ul[0] * sdl * (sdl - sdml);
 
   // F*_L
   Ulst[1] = Ulst[0] * spd[2];
   Ulst[5] = ul[5];
   cl = ul[0] * sdl * sdml - (ul[5] * ul[5]);
-  if (fabs(cl) < SMALL * ptst) {
+  if (std::abs(cl) < Number(SMALL) * ptst) {
     Ulst[2] = Ulst[0] * ul[2] * hl[0];
     Ulst[3] = Ulst[0] * ul[3] * hl[0];
 
@@ -294,7 +328,7 @@ void NumFluxHLLD<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim>
     Ulst[7] = ul[7];
   }
   else {
-    cl = 1.0 / cl;
+    cl = Number(1.0) / cl;
     cm = ul[5] * (sdl - sdml) * cl;
     Ulst[2] = Ulst[0] * (ul[2] * hl[0] - ul[6] * cm);
     Ulst[3] = Ulst[0] * (ul[3] * hl[0] - ul[7] * cm);
@@ -310,7 +344,7 @@ void NumFluxHLLD<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim>
   Urst[1] = Urst[0] * spd[2];
   Urst[5] = ur[5];
   cl = ur[0] * sdr * sdmr - (ur[5] * ur[5]);
-  if (fabs(cl) < SMALL * ptst) {
+  if (std::abs(cl) < Number(SMALL) * ptst) {
     Urst[2] = Urst[0] * ur[2] * hr[0];
     Urst[3] = Urst[0] * ur[3] * hr[0];
 
@@ -318,7 +352,7 @@ void NumFluxHLLD<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim>
     Urst[7] = ur[7];
   }
   else {
-    cl = 1.0 / cl;
+    cl = Number(1.0) / cl;
     cm = ur[5] * (sdr - sdmr) * cl;
     Urst[2] = Urst[0] * (ur[2] * hr[0] - ur[6] * cm);
     Urst[3] = Urst[0] * (ur[3] * hr[0] - ur[7] * cm);
@@ -333,9 +367,9 @@ void NumFluxHLLD<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim>
   if (spd[1] >= 0.0) {
     for (int j = 0; j < n_comp; j++)
       normal_flux[j] = Fl[j] + spd[0] * (Ulst[j] - ul[j]);
-    normal_flux[5] = 0.;
+    normal_flux[5] = Number(0.);
     this->Q_inv(normal_flux, normal_flux, normal);
-    if (this->parameters.debug & this->parameters.NumFlux)
+    if (DEBUG_FLAG_SET(this->parameters, NumFlux))
       for (int j = 0; j < n_comp; j++)
       {
         if ((std::abs(flux_lf[j]) > 1e-10) && (std::abs(normal_flux[j]) > 1e-10))
@@ -349,9 +383,9 @@ void NumFluxHLLD<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim>
   if (spd[3] <= 0.0 && spd[2] < 0.0) {
     for (int j = 0; j < n_comp; j++)
       normal_flux[j] = Fr[j] + spd[4] * (Urst[j] - ur[j]);
-    normal_flux[5] = 0.;
+    normal_flux[5] = Number(0.);
     this->Q_inv(normal_flux, normal_flux, normal);
-    if (this->parameters.debug & this->parameters.NumFlux)
+    if (DEBUG_FLAG_SET(this->parameters, NumFlux))
       for (int j = 0; j < n_comp; j++)
       {
         if ((std::abs(flux_lf[j]) > 1e-10) && (std::abs(normal_flux[j]) > 1e-10))
@@ -362,15 +396,15 @@ void NumFluxHLLD<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim>
   }
 
   // F**_L and F**_R
-  if (0.5 * Bx2 / ptst < SMALL) {
+  if (Number(0.5) * Bx2 / ptst < Number(SMALL)) {
     for (int j = 0; j < n_comp; j++) {
       Uldst[j] = Ulst[j];
       Urdst[j] = Urst[j];
     }
   }
   else {
-    invsumd = 1.0 / (sqrtdl + sqrtdr);
-    Bsgn = (Bx > 0.0) ? 1.0 : -1.0;
+    invsumd = Number(1.0) / (sqrtdl + sqrtdr);
+    Bsgn = (Bx > 0.0) ? Number(1.0) : Number(-1.0);
 
     Uldst[0] = Ulst[0];
     Urdst[0] = Urst[0];
@@ -409,9 +443,9 @@ void NumFluxHLLD<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim>
     cm = spd[1] - spd[0];
     for (int j = 0; j < n_comp; j++)
       normal_flux[j] = Fl[j] + spd[1] * Uldst[j] - spd[0] * ul[j] - cm*Ulst[j];
-    normal_flux[5] = 0.;
+    normal_flux[5] = Number(0.);
     this->Q_inv(normal_flux, normal_flux, normal);
-    if (this->parameters.debug & this->parameters.NumFlux)
+    if (DEBUG_FLAG_SET(this->parameters, NumFlux))
       for (int j = 0; j < n_comp; j++)
       {
         if ((std::abs(flux_lf[j]) > 1e-10) && (std::abs(normal_flux[j]) > 1e-10))
@@ -427,9 +461,9 @@ void NumFluxHLLD<equationsType, dim>::numerical_normal_flux(const Tensor<1, dim>
     cm = spd[3] - spd[4];
     for (int j = 0; j < n_comp; j++)
       normal_flux[j] = Fr[j] + spd[3] * Urdst[j] - spd[4] * ur[j] - cm*Urst[j];
-    normal_flux[5] = 0.;
+    normal_flux[5] = Number(0.);
     this->Q_inv(normal_flux, normal_flux, normal);
-    if (this->parameters.debug & this->parameters.NumFlux)
+    if (DEBUG_FLAG_SET(this->parameters, NumFlux))
       for (int j = 0; j < n_comp; j++)
       {
         if ((std::abs(flux_lf[j]) > 1e-10) && (std::abs(normal_flux[j]) > 1e-10))
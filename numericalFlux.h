@@ -6,18 +6,24 @@
 
 #define n_comp Equations<equationsType, dim>::n_components
 #define n_comp_array std::array<double, Equations<equationsType, dim>::n_components>
+#define n_comp_array_float std::array<float, Equations<equationsType, dim>::n_components>
 
 template <EquationsType equationsType, int dim>
 class NumFlux
 {
 public:
   NumFlux(Parameters<dim>& parameters) : parameters(parameters) {};
-  static void Q(n_comp_array &result, const n_comp_array &W, const Tensor<1, dim> &normal);
-  static void Q_inv(n_comp_array &result, n_comp_array &F, const Tensor<1, dim> &normal);
+  template <typename Number>
+  static void Q(std::array<Number, n_comp> &result, const std::array<Number, n_comp> &W, const Tensor<1, dim> &normal);
+  template <typename Number>
+  static void Q_inv(std::array<Number, n_comp> &result, std::array<Number, n_comp> &F, const Tensor<1, dim> &normal);
 
   // Compute the values for the numerical flux
   virtual void numerical_normal_flux(const Tensor<1, dim> &normal, const n_comp_array &Wplus,
     const n_comp_array &Wminus, n_comp_array &normal_flux, double& max_speed) const = 0;
+  // The same, evaluated in single precision on the float copy of the previous solution (Parameters::single_precision_storage).
+  virtual void numerical_normal_flux(const Tensor<1, dim> &normal, const n_comp_array_float &Wplus,
+    const n_comp_array_float &Wminus, n_comp_array_float &normal_flux, double& max_speed) const = 0;
 protected:
   Parameters<dim>& parameters;
 };
@@ -29,6 +35,12 @@ public:
   NumFluxLaxFriedrich(Parameters<dim>& parameters) : NumFlux<equationsType, dim>(parameters) {};
   void numerical_normal_flux(const Tensor<1, dim> &normal, const n_comp_array &Wplus,
     const n_comp_array &Wminus, n_comp_array &normal_flux, double& max_speed) const;
+  void numerical_normal_flux(const Tensor<1, dim> &normal, const n_comp_array_float &Wplus,
+    const n_comp_array_float &Wminus, n_comp_array_float &normal_flux, double& max_speed) const;
+private:
+  template <typename Number>
+  void compute_numerical_normal_flux(const Tensor<1, dim> &normal, const std::array<Number, n_comp> &Wplus,
+    const std::array<Number, n_comp> &Wminus, std::array<Number, n_comp> &normal_flux, double& max_speed) const;
 };
 
 template <EquationsType equationsType, int dim>
@@ -38,6 +50,12 @@ public:
   NumFluxHLLD(Parameters<dim>& parameters) : NumFlux<equationsType, dim>(parameters) {};
   void numerical_normal_flux(const Tensor<1, dim> &normal, const n_comp_array &Wplus,
     const n_comp_array &Wminus, n_comp_array &normal_flux, double& max_speed) const;
+  void numerical_normal_flux(const Tensor<1, dim> &normal, const n_comp_array_float &Wplus,
+    const n_comp_array_float &Wminus, n_comp_array_float &normal_flux, double& max_speed) const;
+private:
+  template <typename Number>
+  void compute_numerical_normal_flux(const Tensor<1, dim> &normal, const std::array<Number, n_comp> &Wplus,
+    const std::array<Number, n_comp> &Wminus, std::array<Number, n_comp> &normal_flux, double& max_speed) const;
 };
 
 #endif
@@ -3,16 +3,34 @@
 template <int dim>
 Parameters<dim>::Parameters() {
   this->g = 0.;
+  this->use_div_free_space_for_B = false;
+  this->num_flux_type = hlld;
+  this->cfl_coefficient = .05;
+  this->final_time = 1.;
+  this->polynomial_order_dg = 1;
+  this->basis = taylor;
+  this->quadrature_order = 5;
+  this->single_precision_storage = false;
+  this->output_step = -1.;
+  this->patches = 0;
+  this->refinements = std::vector<unsigned int>(dim, 1);
+  this->coarse_mesh_refinements = 0;
 
   this->start_limiting_at = -1.;
   this->gas_gamma = 5. / 3.;
   this->limit = true;
   this->slope_limiter = vertexBased;
   this->output_file_prefix = "";
+  this->output_slices_step = -1.;
+  this->log_mode = LogSink::all_processes;
+  this->log_buffer_size = 4096;
   this->lax_friedrich_stabilization_value = .5;
   this->current_time_step_length = 1.e-6;
+  this->max_time_steps = 0;
 
   this->debug = 0;
+  this->timing = false;
+  this->timing_output_every_nth_step = 0;
   this->output_matrix = false;
   this->output = quiet_solver;
   this->output_rhs = false;
@@ -26,8 +44,21 @@ Parameters<dim>::Parameters() {
   this->ilut_atol = 1e-6;
   this->ilut_rtol = 1.0;
 
+  this->max_cells = 0;
+  this->refine_every_nth_time_step = 1;
+  this->perform_n_initial_refinements = 0;
+  this->refine_threshold = 0.5;
+  this->coarsen_threshold = 0.2;
   this->volume_factor = 4;
   this->time_interval_max_cells_multiplicator = 2.;
+  this->repartition_imbalance_threshold = 0.;
+  this->repartition_check_every_nth_time_step = 10;
+  this->repartition_imbalanced_checks = 2;
+  this->anisotropic_refinement = false;
+  this->anisotropic_refinement_threshold = 0.5;
+  this->p0_reduction = false;
+  this->p0_reduction_threshold = -3.;
+  this->p0_reduction_steps = 10;
 
   this->limit_edges_and_vertices = false;
   this->limitB = true;
@@ -66,6 +97,322 @@ void Parameters<dim>::delete_old_outputs(MPI_Comm& mpi_communicator) const
   }
 }
 
+// Formatting of the list-valued parameters - lists of numbers are separated by ',', lists of tuples by ';'.
+template <typename T>
+static std::string list_to_string(const T* values, unsigned int n)
+{
+  std::stringstream ss;
+  for (unsigned int i = 0; i < n; ++i)
+    ss << (i > 0 ? ", " : "") << values[i];
+  return ss.str();
+}
+
+static std::vector<double> string_to_doubles(const std::string& str)
+{
+  return Utilities::string_to_double(Utilities::split_string_list(str, ','));
+}
+
+static std::vector<std::string> split_tuples(const std::string& str)
+{
+  std::vector<std::string> tuples = Utilities::split_string_list(str, ';');
+  // An empty list is split into a single empty string.
+  if ((tuples.size() == 1) && tuples[0].empty())
+    tuples.clear();
+  return tuples;
+}
+
+template <int dim>
+void Parameters<dim>::declare_parameters(ParameterHandler& prm) const
+{
+  prm.enter_subsection("Mesh");
+  {
+    prm.declare_entry("corner a", list_to_string(&this->corner_a[0], dim), Patterns::List(Patterns::Double(), dim, dim), "First corner of the domain");
+    prm.declare_entry("corner b", list_to_string(&this->corner_b[0], dim), Patterns::List(Patterns::Double(), dim, dim), "Opposite corner of the domain");
+    prm.declare_entry("refinements", list_to_string(this->refinements.data(), this->refinements.size()), Patterns::List(Patterns::Integer(1), dim, dim), "Number of cells in each direction");
+    std::stringstream periodic;
+    for (unsigned int i = 0; i < this->periodic_boundaries.size(); ++i)
+      periodic << (i > 0 ? "; " : "") << list_to_string(this->periodic_boundaries[i].data(), 3);
+    prm.declare_entry("periodic boundaries", periodic.str(), Patterns::List(Patterns::List(Patterns::Integer(0), 3, 3, ","), 0, Patterns::List::max_int_value, ";"),
+      "Periodic boundary pairs, 'boundary id, boundary id, direction' separated by ';'");
+  }
+  prm.leave_subsection();
+
+  prm.enter_subsection("Discretization");
+  {
+    prm.declare_entry("polynomial order", Utilities::int_to_string(this->polynomial_order_dg), Patterns::Integer(0), "Polynomial order for the flow part");
+    prm.declare_entry("basis", this->basis == taylor ? "taylor" : "legendre", Patterns::Selection("taylor|legendre"), "Basis for the flow part (legendre: diagonal mass matrix on Cartesian cells)");
+    prm.declare_entry("quadrature order", Utilities::int_to_string(this->quadrature_order), Patterns::Integer(1), "Quadrature order");
+    prm.declare_entry("single precision storage", this->single_precision_storage ? "true" : "false", Patterns::Bool(), "Store the previous solution read by the assembly in single precision");
+    prm.declare_entry("div-free space for B", this->use_div_free_space_for_B ? "true" : "false", Patterns::Bool(), "Use exactly div-free space for the magnetic field");
+    prm.declare_entry("numerical flux", this->num_flux_type == hlld ? "hlld" : "lax_friedrich", Patterns::Selection("hlld|lax_friedrich"), "Numerical flux");
+    prm.declare_entry("lax friedrich stabilization", to_string_with_precision(this->lax_friedrich_stabilization_value, 16), Patterns::Double(0.), "Stabilization value of the Lax-Friedrich flux");
+    prm.declare_entry("gas gamma", to_string_with_precision(this->gas_gamma, 16), Patterns::Double(1.), "Gas gamma value");
+    prm.declare_entry("gravity", to_string_with_precision(this->g, 16), Patterns::Double(), "Gravity acceleration (in z-direction)");
+  }
+  prm.leave_subsection();
+
+  prm.enter_subsection("Limiter");
+  {
+    prm.declare_entry("limit", this->limit ? "true" : "false", Patterns::Bool(), "Use the slope limiter");
+    prm.declare_entry("slope limiter", this->slope_limiter == vertexBased ? "vertexBased" : "barthJespersen", Patterns::Selection("vertexBased|barthJespersen"), "Slope limiter");
+    prm.declare_entry("start limiting at", to_string_with_precision(this->start_limiting_at, 16), Patterns::Double(), "Time from which the solution is limited");
+    prm.declare_entry("limit edges and vertices", this->limit_edges_and_vertices ? "true" : "false", Patterns::Bool(), "Use also neighbors over edges and vertices");
+    prm.declare_entry("limit B", this->limitB ? "true" : "false", Patterns::Bool(), "Limit also the magnetic field");
+  }
+  prm.leave_subsection();
+
+  prm.enter_subsection("Time");
+  {
+    prm.declare_entry("final time", to_string_with_precision(this->final_time, 16), Patterns::Double(0.), "Final time");
+    prm.declare_entry("cfl coefficient", to_string_with_precision(this->cfl_coefficient, 16), Patterns::Double(0.), "CFL coefficient");
+    prm.declare_entry("initial time step length", to_string_with_precision(this->current_time_step_length, 16), Patterns::Double(0.), "Length of the first time step");
+    prm.declare_entry("max time steps", Utilities::int_to_string(this->max_time_steps), Patterns::Integer(), "Stop after this many time steps (<= 0: no limit)");
+  }
+  prm.leave_subsection();
+
+  prm.enter_subsection("Linear solver");
+  {
+    prm.declare_entry("solver", this->solver == gmres ? "gmres" : "direct", Patterns::Selection("gmres|direct"), "Linear solver (direct only without MPI)");
+    prm.declare_entry("verbose", this->output == verbose_solver ? "true" : "false", Patterns::Bool(), "Verbose linear solver");
+    prm.declare_entry("linear residual", to_string_with_precision(this->linear_residual, 16), Patterns::Double(0.), "Tolerance for linear residual norm");
+    prm.declare_entry("max iterations", Utilities::int_to_string(this->max_iterations), Patterns::Integer(1), "Maximum linear iterations count");
+    prm.declare_entry("ilut fill", to_string_with_precision(this->ilut_fill, 16), Patterns::Double(), "ILUT fill");
+    prm.declare_entry("ilut absolute tolerance", to_string_with_precision(this->ilut_atol, 16), Patterns::Double(), "ILUT absolute tolerance");
+    prm.declare_entry("ilut relative tolerance", to_string_with_precision(this->ilut_rtol, 16), Patterns::Double(), "ILUT relative tolerance");
+    prm.declare_entry("ilut drop tolerance", to_string_with_precision(this->ilut_drop, 16), Patterns::Double(), "ILUT drop tolerance");
+  }
+  prm.leave_subsection();
+
+  prm.enter_subsection("Output");
+  {
+    prm.declare_entry("output file prefix", this->output_file_prefix, Patterns::Anything(), "Prefix of all output files");
+    prm.declare_entry("output step", to_string_with_precision(this->output_step, 16), Patterns::Double(), "Either < 0 (output all steps), or > 0 (time difference between two outputs)");
+    prm.declare_entry("patches", Utilities::int_to_string(this->patches), Patterns::Integer(0), "Number of patches (subdivisions of cells) in the output");
+    std::stringstream planes, lines;
+    for (unsigned int i = 0; i < this->output_planes.size(); ++i)
+      planes << (i > 0 ? "; " : "") << this->output_planes[i].first << ", " << this->output_planes[i].second;
+    for (unsigned int i = 0; i < this->output_lines.size(); ++i)
+      lines << (i > 0 ? "; " : "") << this->output_lines[i].first << ", " << list_to_string(this->output_lines[i].second.data(), dim - 1);
+    prm.declare_entry("output planes", planes.str(), Patterns::List(Patterns::List(Patterns::Double(), 2, 2, ","), 0, Patterns::List::max_int_value, ";"),
+      "Slice planes, 'normal direction, position' separated by ';'");
+    prm.declare_entry("output lines", lines.str(), Patterns::List(Patterns::List(Patterns::Double(), dim, dim, ","), 0, Patterns::List::max_int_value, ";"),
+      "Slice lines, 'direction, positions in the remaining directions' separated by ';'");
+    prm.declare_entry("output slices step", to_string_with_precision(this->output_slices_step, 16), Patterns::Double(), "Either < 0 (output all steps), or > 0 (time difference between two outputs)");
+    prm.declare_entry("output matrix", this->output_matrix ? "true" : "false", Patterns::Bool(), "Output the matrix after assembling");
+    prm.declare_entry("output rhs", this->output_rhs ? "true" : "false", Patterns::Bool(), "Output the rhs after assembling");
+    prm.declare_entry("output solution", this->output_solution ? "true" : "false", Patterns::Bool(), "Output the limited solution after solving");
+    prm.declare_entry("log processes", this->log_mode == LogSink::all_processes ? "all" : (this->log_mode == LogSink::first_process_only ? "first" : "none"),
+      Patterns::Selection("all|first|none"), "Processes that write log messages (first: only the process 0)");
+    prm.declare_entry("log buffer size", Utilities::int_to_string(this->log_buffer_size), Patterns::Integer(0), "Log buffer size in bytes (0: messages are written out immediately)");
+  }
+  prm.leave_subsection();
+
+  prm.enter_subsection("Adaptivity");
+  {
+    prm.declare_entry("max cells", Utilities::int_to_string(this->max_cells), Patterns::Integer(0), "Maximum number of cells");
+    prm.declare_entry("refine every nth time step", Utilities::int_to_string(this->refine_every_nth_time_step), Patterns::Integer(1), "Refinement frequency");
+    prm.declare_entry("initial refinements", Utilities::int_to_string(this->perform_n_initial_refinements), Patterns::Integer(0), "Number of refinements of the initial mesh");
+    prm.declare_entry("refine threshold", to_string_with_precision(this->refine_threshold, 16), Patterns::Double(0.), "Refinement threshold");
+    prm.declare_entry("coarsen threshold", to_string_with_precision(this->coarsen_threshold, 16), Patterns::Double(0.), "Coarsening threshold");
+    prm.declare_entry("volume factor", Utilities::int_to_string(this->volume_factor), Patterns::Integer(), "Volume factor");
+    prm.declare_entry("max cells multiplicator", to_string_with_precision(this->time_interval_max_cells_multiplicator, 16), Patterns::Double(0.), "Time interval max cells multiplicator");
+    prm.declare_entry("assembly indicator components", list_to_string(this->assembly_indicator_components.data(), this->assembly_indicator_components.size()), Patterns::List(Patterns::Integer(0, 2 * dim + 1)),
+      "Components whose face jumps are accumulated during assembly and used as the refinement indicator (empty: the indicator evaluates the solution)");
+    prm.declare_entry("repartition imbalance threshold", to_string_with_precision(this->repartition_imbalance_threshold, 16), Patterns::Double(), "MPI only - if > 0, partition by measured cell cost, and repartition when the max / average cost of processes exceeds this");
+    prm.declare_entry("repartition check every nth time step", Utilities::int_to_string(this->repartition_check_every_nth_time_step), Patterns::Integer(1), "Frequency of the load imbalance check");
+    prm.declare_entry("repartition imbalanced checks", Utilities::int_to_string(this->repartition_imbalanced_checks), Patterns::Integer(1), "Number of consecutive checks over the threshold before repartitioning");
+    prm.declare_entry("anisotropic refinement", this->anisotropic_refinement ? "true" : "false", Patterns::Bool(), "Serial only, not with the div-free space for B - refine cells only in the directions with large jumps");
+    prm.declare_entry("anisotropic refinement threshold", to_string_with_precision(this->anisotropic_refinement_threshold, 16), Patterns::Double(0., 1.), "Fraction of the largest directional jump above which a direction is refined");
+    prm.declare_entry("p0 reduction", this->p0_reduction ? "true" : "false", Patterns::Bool(), "Constrain the non-constant coefficients of non-smooth cells to zero (the number of DoFs is not reduced)");
+    prm.declare_entry("p0 reduction threshold", to_string_with_precision(this->p0_reduction_threshold, 16), Patterns::Double(), "log10 of the share of non-constant modes of density above which a cell is reduced");
+    prm.declare_entry("p0 reduction steps", Utilities::int_to_string(this->p0_reduction_steps), Patterns::Integer(1), "Number of time steps a reduced cell stays piecewise constant before it is evaluated again");
+  }
+  prm.leave_subsection();
+
+  prm.enter_subsection("Debugging");
+  {
+    static const char* flag_names[] = { "BasicSteps", "PeriodicBoundaries", "Assembling", "SlopeLimiting", "NumFlux", "Adaptivity", "DetailSteps" };
+    std::stringstream flags;
+    for (unsigned int i = 0; i < 7; ++i)
+      if (this->debug & (1 << i))
+        flags << (flags.str().empty() ? "" : ", ") << flag_names[i];
+    prm.declare_entry("debug", flags.str(), Patterns::MultipleSelection("BasicSteps|PeriodicBoundaries|Assembling|SlopeLimiting|NumFlux|Adaptivity|DetailSteps"), "Debugging output flags");
+    prm.declare_entry("timing", this->timing ? "true" : "false", Patterns::Bool(), "Timing of the stages of the computation");
+    prm.declare_entry("timing output every nth step", Utilities::int_to_string(this->timing_output_every_nth_step), Patterns::Integer(), "Write the timings every n-th time step (<= 0: only at the end)");
+  }
+  prm.leave_subsection();
+}
+
+template <int dim>
+void Parameters<dim>::parse_parameters(ParameterHandler& prm)
+{
+  prm.enter_subsection("Mesh");
+  {
+    std::vector<double> a = string_to_doubles(prm.get("corner a")), b = string_to_doubles(prm.get("corner b"));
+    for (unsigned int d = 0; d < dim; ++d)
+    {
+      this->corner_a[d] = a[d];
+      this->corner_b[d] = b[d];
+    }
+    std::vector<int> refinements = Utilities::string_to_int(Utilities::split_string_list(prm.get("refinements"), ','));
+    this->refinements.assign(refinements.begin(), refinements.end());
+    std::vector<std::string> periodic = split_tuples(prm.get("periodic boundaries"));
+    this->periodic_boundaries.resize(periodic.size());
+    for (unsigned int i = 0; i < periodic.size(); ++i)
+    {
+      std::vector<int> pair = Utilities::string_to_int(Utilities::split_string_list(periodic[i], ','));
+      for (unsigned int j = 0; j < 3; ++j)
+        this->periodic_boundaries[i][j] = pair[j];
+    }
+  }
+  prm.leave_subsection();
+
+  prm.enter_subsection("Discretization");
+  {
+    this->polynomial_order_dg = prm.get_integer("polynomial order");
+    this->basis = (prm.get("basis") == "taylor") ? taylor : legendre;
+    this->quadrature_order = prm.get_integer("quadrature order");
+    this->single_precision_storage = prm.get_bool("single precision storage");
+    this->use_div_free_space_for_B = prm.get_bool("div-free space for B");
+    this->num_flux_type = (prm.get("numerical flux") == "hlld") ? hlld : lax_friedrich;
+    this->lax_friedrich_stabilization_value = prm.get_double("lax friedrich stabilization");
+    this->gas_gamma = prm.get_double("gas gamma");
+    this->g = prm.get_double("gravity");
+  }
+  prm.leave_subsection();
+
+  prm.enter_subsection("Limiter");
+  {
+    this->limit = prm.get_bool("limit");
+    this->slope_limiter = (prm.get("slope limiter") == "vertexBased") ? vertexBased : barthJespersen;
+    this->start_limiting_at = prm.get_double("start limiting at");
+    this->limit_edges_and_vertices = prm.get_bool("limit edges and vertices");
+    this->limitB = prm.get_bool("limit B");
+  }
+  prm.leave_subsection();
+
+  prm.enter_subsection("Time");
+  {
+    this->final_time = prm.get_double("final time");
+    this->cfl_coefficient = prm.get_double("cfl coefficient");
+    this->current_time_step_length = prm.get_double("initial time step length");
+    this->max_time_steps = prm.get_integer("max time steps");
+  }
+  prm.leave_subsection();
+
+  prm.enter_subsection("Linear solver");
+  {
+    this->solver = (prm.get("solver") == "gmres") ? gmres : direct;
+    this->output = prm.get_bool("verbose") ? verbose_solver : quiet_solver;
+    this->linear_residual = prm.get_double("linear residual");
+    this->max_iterations = prm.get_integer("max iterations");
+    this->ilut_fill = prm.get_double("ilut fill");
+    this->ilut_atol = prm.get_double("ilut absolute tolerance");
+    this->ilut_rtol = prm.get_double("ilut relative tolerance");
+    this->ilut_drop = prm.get_double("ilut drop tolerance");
+  }
+  prm.leave_subsection();
+
+  prm.enter_subsection("Output");
+  {
+    this->output_file_prefix = prm.get("output file prefix");
+    this->output_step = prm.get_double("output step");
+    this->patches = prm.get_integer("patches");
+    std::vector<std::string> planes = split_tuples(prm.get("output planes")), lines = split_tuples(prm.get("output lines"));
+    this->output_planes.resize(planes.size());
+    for (unsigned int i = 0; i < planes.size(); ++i)
+    {
+      std::vector<double> plane = string_to_doubles(planes[i]);
+      this->output_planes[i] = std::make_pair((unsigned int)plane[0], plane[1]);
+    }
+    this->output_lines.resize(lines.size());
+    for (unsigned int i = 0; i < lines.size(); ++i)
+    {
+      std::vector<double> line = string_to_doubles(lines[i]);
+      this->output_lines[i].first = (unsigned int)line[0];
+      for (unsigned int d = 0; d < dim - 1; ++d)
+        this->output_lines[i].second[d] = line[d + 1];
+    }
+    this->output_slices_step = prm.get_double("output slices step");
+    this->output_matrix = prm.get_bool("output matrix");
+    this->output_rhs = prm.get_bool("output rhs");
+    this->output_solution = prm.get_bool("output solution");
+    this->log_mode = (prm.get("log processes") == "all") ? LogSink::all_processes : ((prm.get("log processes") == "first") ? LogSink::first_process_only : LogSink::quiet);
+    this->log_buffer_size = prm.get_integer("log buffer size");
+  }
+  prm.leave_subsection();
+
+  prm.enter_subsection("Adaptivity");
+  {
+    this->max_cells = prm.get_integer("max cells");
+    this->refine_every_nth_time_step = prm.get_integer("refine every nth time step");
+    this->perform_n_initial_refinements = prm.get_integer("initial refinements");
+    this->refine_threshold = prm.get_double("refine threshold");
+    this->coarsen_threshold = prm.get_double("coarsen threshold");
+    this->volume_factor = prm.get_integer("volume factor");
+    this->time_interval_max_cells_multiplicator = prm.get_double("max cells multiplicator");
+    this->repartition_imbalance_threshold = prm.get_double("repartition imbalance threshold");
+    this->repartition_check_every_nth_time_step = prm.get_integer("repartition check every nth time step");
+    this->repartition_imbalanced_checks = prm.get_integer("repartition imbalanced checks");
+    std::vector<std::string> components = Utilities::split_string_list(prm.get("assembly indicator components"), ',');
+    this->assembly_indicator_components.clear();
+    for (unsigned int i = 0; i < components.size(); ++i)
+      if (!components[i].empty())
+        this->assembly_indicator_components.push_back(Utilities::string_to_int(components[i]));
+    this->anisotropic_refinement = prm.get_bool("anisotropic refinement");
+    this->anisotropic_refinement_threshold = prm.get_double("anisotropic refinement threshold");
+    this->p0_reduction = prm.get_bool("p0 reduction");
+    this->p0_reduction_threshold = prm.get_double("p0 reduction threshold");
+    this->p0_reduction_steps = prm.get_integer("p0 reduction steps");
+  }
+  prm.leave_subsection();
+
+  prm.enter_subsection("Debugging");
+  {
+    static const char* flag_names[] = { "BasicSteps", "PeriodicBoundaries", "Assembling", "SlopeLimiting", "NumFlux", "Adaptivity", "DetailSteps" };
+    std::vector<std::string> flags = Utilities::split_string_list(prm.get("debug"), ',');
+    this->debug = None;
+    for (unsigned int i = 0; i < 7; ++i)
+      if (std::find(flags.begin(), flags.end(), flag_names[i]) != flags.end())
+        this->debug |= (1 << i);
+    this->timing = prm.get_bool("timing");
+    this->timing_output_every_nth_step = prm.get_integer("timing output every nth step");
+  }
+  prm.leave_subsection();
+}
+
+void read_parameters(ParameterHandler& prm, int argc, char *argv[])
+{
+  if (argc > 1)
+    prm.read_input(argv[1]);
+
+  for (int i = 2; i < argc; ++i)
+  {
+    const std::string arg(argv[i]);
+    const std::size_t equals = arg.find('='), slash = arg.rfind('/', equals);
+    AssertThrow(equals != std::string::npos, ExcMessage("Parameter arguments must have the form Section/name=value, got: " + arg));
+    // Enter the (possibly nested) sections, set the value, leave the sections.
+    std::vector<std::string> sections;
+    if (slash != std::string::npos)
+      sections = Utilities::split_string_list(arg.substr(0, slash), '/');
+    for (unsigned int s = 0; s < sections.size(); ++s)
+      prm.enter_subsection(sections[s]);
+    prm.set(arg.substr(slash == std::string::npos ? 0 : slash + 1, equals - (slash == std::string::npos ? 0 : slash + 1)), arg.substr(equals + 1));
+    for (unsigned int s = 0; s < sections.size(); ++s)
+      prm.leave_subsection();
+  }
+}
+
+void print_parameters(ParameterHandler& prm, const std::string& output_file_prefix, MPI_Comm& mpi_communicator)
+{
+  if (Utilities::MPI::this_mpi_process(mpi_communicator) != 0)
+    return;
+
+  prm.print_parameters(std::cout, ParameterHandler::ShortText);
+  std::ofstream file((output_file_prefix + "parameters.prm").c_str());
+  prm.print_parameters(file, ParameterHandler::Text);
+}
+
 template <int dim>
 bool Parameters<dim>::is_periodic_boundary(int boundary_id) const
 {
@@ -13,9 +13,14 @@ public:
 
   void delete_old_outputs(MPI_Comm& mpi_communicator) const;
 
+  // Declares all parameters in prm, with the current values as defaults - so that code-set values are used where the input does not say otherwise.
+  void declare_parameters(ParameterHandler& prm) const;
+  // Reads the values of all parameters declared by declare_parameters().
+  void parse_parameters(ParameterHandler& prm);
+
   bool is_periodic_boundary(int boundary_id) const;
 
-  // Use exactly Div-Free space.
+  // Use exactly Div-Free space (with adaptivity, the coarse cells have to be cubes).
   bool use_div_free_space_for_B;
 
   // Gravity acceleration - in z-direction
@@ -48,6 +53,17 @@ public:
 
   // Number of patches
   unsigned int patches; 
+
+  // Slice output - planes given by (normal direction, position).
+  std::vector<std::pair<unsigned int, double> > output_planes;
+  // Slice output - lines given by (direction, positions in the remaining directions in ascending order).
+  std::vector<std::pair<unsigned int, std::array<double, dim - 1> > > output_lines;
+  // Slice output step - either < 0 (output all steps), or > 0 (time difference between two outputs)
+  double output_slices_step;
+
+  // Which processes write log messages, and the size of the log buffer in bytes (0: every message is written out immediately) - applied by Problem.
+  LogSink::Mode log_mode;
+  int log_buffer_size;
   
   // Gas gamma value.
   double gas_gamma;
@@ -73,17 +89,27 @@ public:
 
   // Global - obvious
   double current_time_step_length, final_time, cfl_coefficient;
+  // Stop after this many time steps even if final_time has not been reached (<= 0: no limit).
+  int max_time_steps;
   // Polynomial order for the flow part.
   int polynomial_order_dg;
+  // Basis of the flow part - Taylor (monomials), or Legendre (orthogonal on Cartesian cells: diagonal mass matrix, inverted directly unless the div-free space for B is used).
+  enum Basis { taylor, legendre };
+  Basis basis;
   // Quadrature order.
   int quadrature_order;
+  // Store the previous solution read by the assembly in single precision, and evaluate the states in the quadrature points, the flux matrix
+  // and the numerical flux in single precision (the integrals, the system and the solution stay in double).
+  bool single_precision_storage;
 
   Point<dim> corner_a;
   Point<dim> corner_b;
   std::vector<unsigned int> refinements;
   std::vector<std::array<int, 3> > periodic_boundaries;
+  // Global refinements of the coarse mesh the initial mesh was built with (see create_box() in util.h) - adaptivity does not coarsen the initial cells.
+  unsigned int coarse_mesh_refinements;
 
-  // Debugging
+  // Debugging - Assembling, SlopeLimiting, NumFlux and DetailSteps only have effect in builds with MHDEAL_DEBUG_LOGGING (see util.h).
   enum DebuggingFlag
   {
     None = 0,
@@ -97,14 +123,48 @@ public:
   };
   int debug;
 
+  // Timing of the stages of Problem::run(), summary printed at the end.
+  bool timing;
+  // Write the cumulative timings to <output_file_prefix>timing.csv every n-th time step (<= 0: only at the end).
+  int timing_output_every_nth_step;
+
   // Adaptivity
   int max_cells;
   int refine_every_nth_time_step;
+  // Refinements of the initial mesh for the (projected) initial condition, before the first time step (see Problem::refine_initial_mesh()).
   int perform_n_initial_refinements;
   double refine_threshold;
   double coarsen_threshold;
   int volume_factor;
   double time_interval_max_cells_multiplicator;
+  // Load balancing (MPI only) - if > 0, the measured assembly cost of cells weights the partitioning, and the mesh is repartitioned
+  // whenever the most loaded process has more than this multiple of the average cost (e.g. 1.2); <= 0: partitioning by cell count.
+  double repartition_imbalance_threshold;
+  // The imbalance is checked every this many time steps (the check is collective), and the mesh is repartitioned only if it exceeds
+  // the threshold in this many consecutive checks (refinement repartitions on its own and restarts the count).
+  int repartition_check_every_nth_time_step;
+  int repartition_imbalanced_checks;
+  // Components (of the conservative state) whose jumps over interior faces are accumulated during assembly, and used as the refinement indicator
+  // instead of re-evaluating the solution (empty: off). The indicator is that of the last assembly, i.e. one time step old.
+  std::vector<unsigned int> assembly_indicator_components;
+  // Serial only, and not with the div-free space for B (whose transfer matrices are exact for cubes only) - refine cells only in the directions
+  // whose average face jump is at least this fraction of the largest one.
+  bool anisotropic_refinement;
+  double anisotropic_refinement_threshold;
+  // Local reduction to P0 via constraints (not hp adaptivity) - cells where the (Persson-Peraire) smoothness indicator of density, log10 of the share
+  // of the non-constant modes in its L2-norm, exceeds the threshold have their non-constant coefficients constrained to zero for p0_reduction_steps
+  // time steps. A cell is either P0 or of the full degree. The element and the DoFHandler stay those of the full degree, so the number of DoFs and
+  // the size of the linear system do not change; only the constrained basis functions are skipped in the assembly.
+  bool p0_reduction;
+  double p0_reduction_threshold;
+  int p0_reduction_steps;
 };
 
+// Reads the parameter file given as the first command-line argument (if any), then applies the remaining arguments of the form "Section/name=value".
+// Throws on syntax errors, undeclared parameters and values not matching the declared patterns.
+void read_parameters(ParameterHandler& prm, int argc, char *argv[]);
+
+// Prints the effective configuration (on the main process only), and writes it to <output_file_prefix>parameters.prm, so that the run can be repeated.
+void print_parameters(ParameterHandler& prm, const std::string& output_file_prefix, MPI_Comm& mpi_communicator);
+
 #endif
\ No newline at end of file
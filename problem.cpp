@@ -8,39 +8,55 @@ Problem<equationsType, dim>::Problem(Parameters<dim>& parameters, Equations<equa
   Triangulation<dim>& triangulation,
 #endif
   InitialCondition<equationsType, dim>& initial_condition, BoundaryCondition<equationsType, dim>& boundary_conditions) :
-  mpi_communicator(MPI_COMM_WORLD),
-  parameters(parameters),
-  equations(equations),
+  reset_after_refinement(true),
+  average_cell_cost(0.),
+  imbalanced_checks(0),
   triangulation(triangulation),
+  equations(equations),
+  parameters(parameters),
   initial_condition(initial_condition),
   boundary_conditions(boundary_conditions),
+  solver(new AztecOO()),
+  diagonal_mass_matrix((parameters.basis == Parameters<dim>::legendre) && !parameters.use_div_free_space_for_B),
   mapping(),
-  fe(parameters.use_div_free_space_for_B ? FESystem<dim>(FE_DG_Taylor<dim>(parameters.polynomial_order_dg), 5, FE_DG_DivFree<dim>(), 1) : FESystem<dim>(FE_DG_Taylor<dim>(parameters.polynomial_order_dg), 8)), dof_handler(triangulation),
+  fe(create_fe(parameters)), dof_handler(triangulation),
   quadrature(parameters.quadrature_order),
   face_quadrature(parameters.quadrature_order),
-  last_output_time(0.), time(0.),
+  mpi_communicator(MPI_COMM_WORLD),
+  last_output_time(0.), last_slice_output_time(0.), time(0.),
   time_step_number(0),
   mag(dim + 2),
+  bc_needs_gradients(boundary_conditions_need_gradients()),
   update_flags(update_values | update_JxW_values | update_gradients),
-  face_update_flags(update_values | update_JxW_values | update_normal_vectors | update_q_points | update_gradients),
+  face_update_flags(update_values | update_JxW_values | update_normal_vectors | update_q_points),
+  boundary_face_update_flags(face_update_flags | (bc_needs_gradients ? update_gradients : update_default)),
   neighbor_face_update_flags(update_values | update_q_points),
   fe_v_cell(mapping, fe, quadrature, update_flags),
   fe_v_face(mapping, fe, face_quadrature, face_update_flags),
-  fe_v_face_neighbor(mapping, fe, face_quadrature, neighbor_face_update_flags),
+  fe_v_face_boundary(mapping, fe, face_quadrature, boundary_face_update_flags),
   fe_v_subface(mapping, fe, face_quadrature, face_update_flags),
+  fe_v_face_neighbor(mapping, fe, face_quadrature, neighbor_face_update_flags),
   fe_v_subface_neighbor(mapping, fe, face_quadrature, neighbor_face_update_flags),
   adaptivity(0),
-  solver(new AztecOO()),
-  reset_after_refinement(true)
+  timing(parameters, mpi_communicator)
 {
+  // The mass matrix (and the transfer matrices) of the element are integrated exactly only then.
+  AssertThrow(parameters.quadrature_order > parameters.polynomial_order_dg, ExcMessage("The quadrature order has to be higher than the polynomial order."));
+  // The grid transfer matrices of the div-free element are those of a cube (its functions 9 and 10 depend on the aspect ratio of the cell), and
+  // anisotropic refinement produces non-cubic children of cubic parents, and non-cubic parents.
+  AssertThrow(!(parameters.anisotropic_refinement && parameters.use_div_free_space_for_B), ExcMessage("Anisotropic refinement is not supported with the div-free space for B."));
+  this->solution_limited = false;
+  LogSink::instance().set_mode(parameters.log_mode);
+  LogSink::instance().set_buffer_size(parameters.log_buffer_size);
   n_quadrature_points_cell = quadrature.get_points().size();
-  fluxes_old.resize(n_quadrature_points_cell);
-  W_prev.resize(n_quadrature_points_cell);
   n_quadrature_points_face = face_quadrature.get_points().size();
-  Wplus_old.resize(n_quadrature_points_face);
+  if (parameters.single_precision_storage)
+    quadrature_states_float.resize(n_quadrature_points_cell, n_quadrature_points_face);
+  else
+    quadrature_states_double.resize(n_quadrature_points_cell, n_quadrature_points_face);
+  Wplus_boundary.resize(n_quadrature_points_face);
+  Wminus_boundary.resize(n_quadrature_points_face);
   Wgrad_plus_old.resize(n_quadrature_points_face);
-  Wminus_old.resize(n_quadrature_points_face);
-  normal_fluxes_old.resize(n_quadrature_points_face);
 
   if (parameters.num_flux_type == parameters.hlld)
     this->numFlux = new NumFluxHLLD<equationsType, dim>(this->parameters);
@@ -51,12 +67,52 @@ Problem<equationsType, dim>::Problem(Parameters<dim>& parameters, Equations<equa
     this->slopeLimiter = new VertexBasedSlopeLimiter<equationsType, dim>(parameters, mapping, fe, dof_handler, dofs_per_cell, triangulation, dof_indices, component_ii, is_primitive);
   else if (parameters.slope_limiter == parameters.barthJespersen)
     this->slopeLimiter = new BarthJespersenSlopeLimiter<equationsType, dim>(parameters, mapping, fe, dof_handler, dofs_per_cell, triangulation, dof_indices, component_ii, is_primitive);
+
+#ifdef HAVE_MPI
+  if (parameters.repartition_imbalance_threshold > 0.)
+    triangulation.signals.cell_weight.connect(std::bind(&Problem<equationsType, dim>::cell_weight, this, std::placeholders::_1, std::placeholders::_2));
+#endif
+}
+
+template <EquationsType equationsType, int dim>
+bool Problem<equationsType, dim>::boundary_conditions_need_gradients() const
+{
+  const std::vector<types::boundary_id> boundary_ids = triangulation.get_boundary_ids();
+  for (unsigned int i = 0; i < boundary_ids.size(); ++i)
+    if (!parameters.is_periodic_boundary(boundary_ids[i]) && (boundary_conditions.dependencies(boundary_ids[i]) & BoundaryCondition<equationsType, dim>::depends_on_gradients))
+      return true;
+  return false;
 }
 
 template <EquationsType equationsType, int dim>
 void Problem<equationsType, dim>::set_adaptivity(Adaptivity<dim>* adaptivity)
 {
+  // The grid transfer matrices of the div-free element are those of a cube - cubic coarse cells stay cubic under isotropic refinement,
+  // other cells would transfer B wrongly.
+  if (parameters.use_div_free_space_for_B)
+    for (typename Triangulation<dim>::cell_iterator coarse_cell = triangulation.begin(0); coarse_cell != triangulation.end(0); ++coarse_cell)
+    {
+      const Point<dim> h = cell_extents<dim>(coarse_cell);
+      for (unsigned int d = 1; d < dim; ++d)
+        AssertThrow(std::abs(h[d] - h[0]) <= 1e-10 * h[0], ExcMessage("Adaptivity with the div-free space for B requires cubic coarse cells."));
+    }
   this->adaptivity = adaptivity;
+  if (!parameters.assembly_indicator_components.empty())
+    this->adaptivity->set_assembly_jumps(&this->assembly_jumps, &this->assembly_areas);
+}
+
+template <EquationsType equationsType, int dim>
+FESystem<dim> Problem<equationsType, dim>::create_fe(const Parameters<dim>& parameters)
+{
+  if (parameters.basis == Parameters<dim>::legendre)
+  {
+    if (parameters.use_div_free_space_for_B)
+      return FESystem<dim>(FE_DG_LegendreCartesian<dim>(parameters.polynomial_order_dg), 5, FE_DG_DivFree<dim>(), 1);
+    return FESystem<dim>(FE_DG_LegendreCartesian<dim>(parameters.polynomial_order_dg), 8);
+  }
+  if (parameters.use_div_free_space_for_B)
+    return FESystem<dim>(FE_DG_Taylor<dim>(parameters.polynomial_order_dg), 5, FE_DG_DivFree<dim>(), 1);
+  return FESystem<dim>(FE_DG_Taylor<dim>(parameters.polynomial_order_dg), 8);
 }
 
 template <EquationsType equationsType, int dim>
@@ -82,21 +138,132 @@ void Problem<equationsType, dim>::setup_system()
   system_matrix.reinit(locally_owned_dofs, locally_owned_dofs, dsp, mpi_communicator);
 
   precalculate_global();
+  if (parameters.single_precision_storage)
+    prev_cellwise_float.reinit(dof_handler);
+  else
+    prev_cellwise.reinit(dof_handler);
+
+  cell_costs.assign(triangulation.n_active_cells(), 0.);
+  reduced_degree_steps.assign(triangulation.n_active_cells(), 0);
 }
 
 template <EquationsType equationsType, int dim>
-void Problem<equationsType, dim>::postprocess()
+void Problem<equationsType, dim>::make_degree_constraints()
 {
-  current_limited_solution = current_unlimited_solution;
-  constraints.distribute(current_limited_solution);
+  // The sparsity pattern (from setup_system()) is that of the full degree everywhere, which contains that of the reduced cells.
+  constraints.clear();
+  constraints.reinit(locally_relevant_dofs);
+  DoFTools::make_hanging_node_constraints(dof_handler, constraints);
+  for (typename DoFHandler<dim>::active_cell_iterator c = dof_handler.begin_active(); c != dof_handler.end(); ++c)
+  {
+    if (!c->is_locally_owned() || (this->reduced_degree_steps[c->active_cell_index()] == 0))
+      continue;
+    c->get_dof_indices(dof_indices);
+    for (unsigned int i = 0; i < dofs_per_cell; ++i)
+      if (!basis_fn_in_p0[i] && !constraints.is_constrained(dof_indices[i]))
+        constraints.add_line(dof_indices[i]);
+  }
+  constraints.close();
+}
+
+template <EquationsType equationsType, int dim>
+void Problem<equationsType, dim>::update_cell_degrees()
+{
+  // The indicator of a cell - the share of the non-constant modes in the L2-norm of density (Persson, Peraire, 2006).
+  // A reduced cell has no such modes, so it returns to the full degree after Parameters::p0_reduction_steps, and is evaluated again then.
+  const double threshold = std::pow(10., parameters.p0_reduction_threshold);
+  bool changed = false;
+  for (typename DoFHandler<dim>::active_cell_iterator c = dof_handler.begin_active(); c != dof_handler.end(); ++c)
+  {
+    if (!c->is_locally_owned())
+      continue;
+    const unsigned int index = c->active_cell_index();
+    if (this->reduced_degree_steps[index] > 0)
+    {
+      if (--this->reduced_degree_steps[index] == 0)
+        changed = true;
+      continue;
+    }
+
+    fe_v_cell.reinit(c);
+    c->get_dof_indices(dof_indices);
+    const std::vector<double> &JxW = fe_v_cell.get_JxW_values();
+    double norm = 0., non_constant_norm = 0.;
+    for (unsigned int q = 0; q < n_quadrature_points_cell; ++q)
+    {
+      double value = 0., non_constant_value = 0.;
+      for (unsigned int i = 0; i < dofs_per_cell; ++i)
+      {
+        if (!is_primitive[i] || (component_ii[i] != 0))
+          continue;
+        const double contribution = prev_solution(dof_indices[i]) * fe_v_cell.shape_value(i, q);
+        value += contribution;
+        if (!basis_fn_is_constant[i])
+          non_constant_value += contribution;
+      }
+      norm += value * value * JxW[q];
+      non_constant_norm += non_constant_value * non_constant_value * JxW[q];
+    }
+    if ((norm > 0.) && (non_constant_norm > threshold * norm))
+    {
+      this->reduced_degree_steps[index] = parameters.p0_reduction_steps;
+      changed = true;
+    }
+  }
 
+  if (Utilities::MPI::max((unsigned int)changed, mpi_communicator) == 0)
+    return;
+
+  make_degree_constraints();
+  // The newly reduced cells lose their non-constant modes (which keeps the cell means of the linear ones, as they have zero mean).
+  TrilinosWrappers::MPI::Vector projected_solution(locally_owned_dofs, mpi_communicator);
+  projected_solution = this->prev_solution;
+  constraints.distribute(projected_solution);
+  this->prev_solution = projected_solution;
+  // The matrix has to be reassembled.
+  this->reset_after_refinement = true;
+}
+
+template <EquationsType equationsType, int dim>
+void Problem<equationsType, dim>::postprocess()
+{
   this->slopeLimiter->postprocess(current_limited_solution, current_unlimited_solution);
+  this->solution_limited = true;
+}
+
+template <EquationsType equationsType, int dim>
+void Problem<equationsType, dim>::advance_solution()
+{
+  // The unlimited solution is the current one - its ghost values are already there.
+  if (this->solution_limited)
+    this->prev_solution = this->current_limited_solution;
+  else
+    this->prev_solution.swap(this->current_unlimited_solution);
+}
+
+template <EquationsType equationsType, int dim>
+double Problem<equationsType, dim>::minimal_cell_length() const
+{
+  // Isotropic refinement keeps the shapes of the coarse cells, the diameter is used as before (also for flat cells).
+  if (!parameters.anisotropic_refinement)
+    return GridTools::minimal_cell_diameter(this->triangulation);
+
+  double min_extent = std::numeric_limits<double>::max();
+  for (typename Triangulation<dim>::active_cell_iterator cell = triangulation.begin_active(); cell != triangulation.end(); ++cell)
+  {
+    if (!cell->is_locally_owned())
+      continue;
+    const Point<dim> h = cell_extents<dim>(cell);
+    for (unsigned int d = 0; d < dim; ++d)
+      min_extent = std::min(min_extent, h[d]);
+  }
+  return std::sqrt((double)dim) * Utilities::MPI::min(min_extent, mpi_communicator);
 }
 
 template <EquationsType equationsType, int dim>
 void Problem<equationsType, dim>::calculate_cfl_condition()
 {
-  cfl_time_step = parameters.cfl_coefficient * GridTools::minimal_cell_diameter(this->triangulation) / this->max_signal_speed;
+  cfl_time_step = parameters.cfl_coefficient * minimal_cell_length() / this->max_signal_speed;
 }
 
 template <EquationsType equationsType, int dim>
@@ -105,6 +272,11 @@ void Problem<equationsType, dim>::precalculate_global()
   dofs_per_cell = dof_handler.get_fe().dofs_per_cell;
   this->dof_indices.resize(dofs_per_cell);
   this->dof_indices_neighbor.resize(dofs_per_cell);
+  // Sized from the element - the limiters hold references to these.
+  component_ii.resize(dofs_per_cell);
+  is_primitive.resize(dofs_per_cell);
+  basis_fn_is_constant.resize(dofs_per_cell);
+  basis_fn_in_p0.resize(dofs_per_cell);
 
   for (unsigned int i = 0; i < dofs_per_cell; ++i)
   {
@@ -120,6 +292,7 @@ void Problem<equationsType, dim>::precalculate_global()
       component_ii[i] = 999;
       basis_fn_is_constant[i] = false;
     }
+    basis_fn_in_p0[i] = dynamic_cast<const FiniteElementIsConstantInterface<dim>*>(&(this->fe.base_element(component_i)))->is_constant(this->fe.system_to_base_index(i).second);
   }
 }
 
@@ -128,10 +301,42 @@ void Problem<equationsType, dim>::assemble_system(bool assemble_matrix)
 {
   this->max_signal_speed = 0.;
 
+  if (!parameters.assembly_indicator_components.empty())
+  {
+    std::array<double, dim> zero;
+    zero.fill(0.);
+    assembly_jumps.assign(triangulation.n_active_cells(), zero);
+    assembly_areas.assign(triangulation.n_active_cells(), zero);
+  }
+
+  // The cells (and their neighbors) read the previous solution from the cellwise copy.
+  if (parameters.single_precision_storage)
+  {
+    prev_cellwise_float.gather(prev_solution);
+    assemble_cells(prev_cellwise_float, assemble_matrix);
+  }
+  else
+  {
+    prev_cellwise.gather(prev_solution);
+    assemble_cells(prev_cellwise, assemble_matrix);
+  }
+
+  if (assemble_matrix)
+    system_matrix.compress(VectorOperation::add);
+  system_rhs.compress(VectorOperation::add);
+}
+
+template <EquationsType equationsType, int dim>
+template <typename Number>
+void Problem<equationsType, dim>::assemble_cells(const CellwiseSolution<dim, Number>& cellwise, bool assemble_matrix)
+{
   // Local (cell) matrices and rhs - for the currently assembled element and the neighbor
   FullMatrix<double> cell_matrix(dofs_per_cell, dofs_per_cell);
   Vector<double> cell_rhs(dofs_per_cell);
 
+  const bool measure_cell_costs = (parameters.repartition_imbalance_threshold > 0.);
+  std::chrono::steady_clock::time_point cell_start;
+
   // Loop through all cells.
   int ith_cell = 0;
   for (cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
@@ -140,6 +345,9 @@ void Problem<equationsType, dim>::assemble_system(bool assemble_matrix)
     if (!cell->is_locally_owned())
       continue;
 
+    if (measure_cell_costs)
+      cell_start = std::chrono::steady_clock::now();
+    timing.start(timing_assemble_cells);
     fe_v_cell.reinit(cell);
 
     if (assemble_matrix)
@@ -147,71 +355,84 @@ void Problem<equationsType, dim>::assemble_system(bool assemble_matrix)
     cell_rhs = 0;
 
     cell->get_dof_indices(dof_indices);
+    const Number* values = cellwise.cell_values(cell->active_cell_index());
+    cell_reduced = is_reduced(cell->active_cell_index());
 
-    if (parameters.debug & parameters.DetailSteps)
+    if (DEBUG_FLAG_SET(parameters, DetailSteps))
       LOGL(2, "Cell: " << ith_cell);
     ith_cell++;
 
     // Assemble the volumetric integrals.
-    assemble_cell_term(cell_matrix, cell_rhs, assemble_matrix);
+    assemble_cell_term(cell_matrix, cell_rhs, assemble_matrix, cellwise, values);
+    timing.stop(timing_assemble_cells);
 
-    // Assemble the face integrals, only after the first (projection) step
-    //if (time_step_number > 0)
+    // Assemble the face integrals.
     {
+      timing.start(timing_assemble_faces);
       for (unsigned int face_no = 0; face_no < GeometryInfo<dim>::faces_per_cell; ++face_no)
       {
-        if (parameters.debug & parameters.DetailSteps)
+        if (DEBUG_FLAG_SET(parameters, DetailSteps))
           LOG(3, "Face: " << face_no);
         // Boundary face - here we pass the boundary id
         if (cell->at_boundary(face_no) && !(this->parameters.is_periodic_boundary(cell->face(face_no)->boundary_id())))
         {
-          if (parameters.debug & parameters.DetailSteps)
+          if (DEBUG_FLAG_SET(parameters, DetailSteps))
             LOGL(1, " - boundary");
-          fe_v_face.reinit(cell, face_no);
-          assemble_face_term(face_no, fe_v_face, fe_v_face, true, cell->face(face_no)->boundary_id(), cell_rhs);
+          fe_v_face_boundary.reinit(cell, face_no);
+          assemble_face_term(face_no, fe_v_face_boundary, fe_v_face_boundary, true, cell->face(face_no)->boundary_id(), cell_rhs, cellwise, values, values);
         }
         else
         {
+          // With anisotropic refinement, the neighbor may be refined without the face being split (and the other way round), and its level says nothing
+          // about the face - so interior faces are distinguished by the face itself (periodic faces are refined isotropically).
+          const bool periodic_face = this->parameters.is_periodic_boundary(cell->face(face_no)->boundary_id());
+
           // Here the neighbor face is more split than the current one (has children with respect to the current face of the current element), we need to assemble sub-face by sub-face
           // Not performed if there is no adaptivity involved.
-          if (cell->neighbor_or_periodic_neighbor(face_no)->has_children())
+          if (periodic_face ? cell->periodic_neighbor(face_no)->has_children() : cell->face(face_no)->has_children())
           {
             int n_children = cell->face(face_no)->number_of_children();
             unsigned int neighbor2;
-            if (this->parameters.is_periodic_boundary(cell->face(face_no)->boundary_id()))
+            if (periodic_face)
               neighbor2 = cell->periodic_neighbor_of_periodic_neighbor(face_no);
             else
-              neighbor2 = cell->neighbor_of_neighbor(face_no);
+              neighbor2 = cell->neighbor_face_no(face_no);
 
-            if (parameters.debug & parameters.DetailSteps)
+            if (DEBUG_FLAG_SET(parameters, DetailSteps))
               LOGL(1, " - neighbor more split, " << n_children << " children");
 
             for (unsigned int subface_no = 0; subface_no < n_children; ++subface_no)
             {
-              const typename DoFHandler<dim>::active_cell_iterator neighbor_child =
-                (this->parameters.is_periodic_boundary(cell->face(face_no)->boundary_id()) ?
+              typename DoFHandler<dim>::cell_iterator neighbor_child =
+                (periodic_face ?
                   cell->periodic_neighbor_child_on_subface(face_no, subface_no) :
                   cell->neighbor_child_on_subface(face_no, subface_no));
+              // Refined (anisotropically) parallel to the subface - its child on the subface.
+              while (neighbor_child->has_children())
+                neighbor_child = neighbor_child->child(GeometryInfo<dim>::child_cell_on_face(neighbor_child->refinement_case(), neighbor2, 0));
 
               fe_v_subface.reinit(cell, face_no, subface_no);
               fe_v_face_neighbor.reinit(neighbor_child, neighbor2);
               neighbor_child->get_dof_indices(dof_indices_neighbor);
+              neighbor_reduced = is_reduced(neighbor_child->active_cell_index());
 
-              assemble_face_term(face_no, fe_v_subface, fe_v_face_neighbor, false, numbers::invalid_unsigned_int, cell_rhs);
+              assemble_face_term(face_no, fe_v_subface, fe_v_face_neighbor, false, numbers::invalid_unsigned_int, cell_rhs,
+                cellwise, values, cellwise.cell_values(neighbor_child->active_cell_index()));
             }
           }
           // Here the neighbor face is less split than the current one, there is some transformation needed.
           // Not performed if there is no adaptivity involved.
-          else if (cell->neighbor_or_periodic_neighbor(face_no)->level() != cell->level())
+          else if (periodic_face ? (cell->periodic_neighbor(face_no)->level() != cell->level()) : cell->neighbor_is_coarser(face_no))
           {
-            if (parameters.debug & parameters.DetailSteps)
+            if (DEBUG_FLAG_SET(parameters, DetailSteps))
               LOGL(1, " - neighbor less split");
             const typename DoFHandler<dim>::cell_iterator neighbor = cell->neighbor_or_periodic_neighbor(face_no);
-            Assert(neighbor->level() == cell->level() - 1, ExcInternalError());
+            Assert(!periodic_face || (neighbor->level() == cell->level() - 1), ExcInternalError());
             neighbor->get_dof_indices(dof_indices_neighbor);
+            neighbor_reduced = is_reduced(neighbor->active_cell_index());
 
             const std::pair<unsigned int, unsigned int> faceno_subfaceno =
-              (this->parameters.is_periodic_boundary(cell->face(face_no)->boundary_id()) ?
+              (periodic_face ?
                 cell->periodic_neighbor_of_coarser_periodic_neighbor(face_no) :
                 cell->neighbor_of_coarser_neighbor(face_no));
 
@@ -220,49 +441,94 @@ void Problem<equationsType, dim>::assemble_system(bool assemble_matrix)
             fe_v_face.reinit(cell, face_no);
             fe_v_subface_neighbor.reinit(neighbor, neighbor_face_no, neighbor_subface_no);
 
-            assemble_face_term(face_no, fe_v_face, fe_v_subface_neighbor, false, numbers::invalid_unsigned_int, cell_rhs);
+            assemble_face_term(face_no, fe_v_face, fe_v_subface_neighbor, false, numbers::invalid_unsigned_int, cell_rhs,
+              cellwise, values, cellwise.cell_values(neighbor->active_cell_index()));
           }
           // Here the neighbor face fits exactly the current face of the current element, this is the 'easy' part.
           // This is the only face assembly case performed without adaptivity.
           else
           {
-            if (parameters.debug & parameters.DetailSteps)
+            if (DEBUG_FLAG_SET(parameters, DetailSteps))
               LOGL(1, " - neighbor equally split");
-            const typename DoFHandler<dim>::cell_iterator neighbor = cell->neighbor_or_periodic_neighbor(face_no);
-            neighbor->get_dof_indices(dof_indices_neighbor);
-
-            fe_v_face.reinit(cell, face_no);
             const unsigned int neighbor2 =
-              (this->parameters.is_periodic_boundary(cell->face(face_no)->boundary_id()) ?
+              (periodic_face ?
                 cell->periodic_neighbor_of_periodic_neighbor(face_no) :
-                cell->neighbor_of_neighbor(face_no));
+                cell->neighbor_face_no(face_no));
+            // A neighbor of the same level may be refined (anisotropically) parallel to the face, then its child on the face is the neighbor.
+            typename DoFHandler<dim>::cell_iterator neighbor = cell->neighbor_or_periodic_neighbor(face_no);
+            while (neighbor->has_children())
+              neighbor = neighbor->child(GeometryInfo<dim>::child_cell_on_face(neighbor->refinement_case(), neighbor2, 0));
+            neighbor->get_dof_indices(dof_indices_neighbor);
+            neighbor_reduced = is_reduced(neighbor->active_cell_index());
 
+            fe_v_face.reinit(cell, face_no);
             fe_v_face_neighbor.reinit(neighbor, neighbor2);
-            assemble_face_term(face_no, fe_v_face, fe_v_face_neighbor, false, numbers::invalid_unsigned_int, cell_rhs);
+            assemble_face_term(face_no, fe_v_face, fe_v_face_neighbor, false, numbers::invalid_unsigned_int, cell_rhs,
+              cellwise, values, cellwise.cell_values(neighbor->active_cell_index()));
           }
         }
       }
+      timing.stop(timing_assemble_faces);
     }
     if (assemble_matrix)
       constraints.distribute_local_to_global(cell_matrix, cell_rhs, dof_indices, system_matrix, system_rhs);
     else
       constraints.distribute_local_to_global(cell_rhs, dof_indices, system_rhs);
+
+    if (measure_cell_costs)
+    {
+      // Averaged with the previous steps, single measurements are noisy.
+      const double cost = std::chrono::duration<double>(std::chrono::steady_clock::now() - cell_start).count();
+      double& cell_cost = cell_costs[cell->active_cell_index()];
+      cell_cost = (cell_cost > 0. ? 0.5 * (cell_cost + cost) : cost);
+    }
   }
-  if (assemble_matrix)
-    system_matrix.compress(VectorOperation::add);
-  system_rhs.compress(VectorOperation::add);
 }
 
 template <EquationsType equationsType, int dim>
+template <typename Number>
+void Problem<equationsType, dim>::evaluate_state(const CellwiseSolution<dim, Number>& cellwise, const Number* values, const FEValuesBase<dim>& fe_v, const unsigned int q,
+  const bool reduced, std::array<Number, Equations<equationsType, dim>::n_components>& W) const
+{
+  double W_sum[Equations<equationsType, dim>::n_components];
+  for (unsigned int c = 0; c < Equations<equationsType, dim>::n_components; ++c)
+  {
+    double value = 0.;
+    for (unsigned int p = cellwise.block_start(c); p < cellwise.block_start(c + 1); ++p)
+      if (!skip_basis_fn(cellwise.dof(p), reduced))
+        value += values[p] * fe_v.shape_value(cellwise.dof(p), q);
+    W_sum[c] = value;
+  }
+  for (unsigned int p = cellwise.block_start(Equations<equationsType, dim>::n_components); p < dofs_per_cell; ++p)
+  {
+    const unsigned int i = cellwise.dof(p);
+    if (skip_basis_fn(i, reduced))
+      continue;
+    Tensor<1, dim> fe_v_value = fe_v[mag].value(i, q);
+    for (unsigned int d = 0; d < dim; d++)
+      W_sum[5 + d] += values[p] * fe_v_value[d];
+  }
+  for (unsigned int c = 0; c < Equations<equationsType, dim>::n_components; ++c)
+    W[c] = W_sum[c];
+}
+
+template <EquationsType equationsType, int dim>
+template <typename Number>
 void
-Problem<equationsType, dim>::assemble_cell_term(FullMatrix<double>& cell_matrix, Vector<double>& cell_rhs, bool assemble_matrix)
+Problem<equationsType, dim>::assemble_cell_term(FullMatrix<double>& cell_matrix, Vector<double>& cell_rhs, bool assemble_matrix, const CellwiseSolution<dim, Number>& cellwise, const Number* values)
 {
   if (assemble_matrix)
   {
     for (unsigned int i = 0; i < dofs_per_cell; ++i)
     {
-      for (unsigned int j = 0; j < dofs_per_cell; ++j)
+      if (skip_basis_fn(i, cell_reduced))
+        continue;
+      // Only the diagonal is used by solve() with a diagonal mass matrix (the rest is zero up to the quadrature error).
+      const unsigned int j_begin = (this->diagonal_mass_matrix ? i : 0), j_end = (this->diagonal_mass_matrix ? i + 1 : dofs_per_cell);
+      for (unsigned int j = j_begin; j < j_end; ++j)
       {
+        if (skip_basis_fn(j, cell_reduced))
+          continue;
         double val = 0.;
         if (is_primitive[i])
         {
@@ -306,32 +572,18 @@ Problem<equationsType, dim>::assemble_cell_term(FullMatrix<double>& cell_matrix,
     }
   }
 
-  if (time_step_number == 0)
-    initial_condition.vector_value(fe_v_cell.get_quadrature_points(), W_prev);
-  else
-  {
-    // Now we calculate the previous values. For this we need to employ the previous FEValues
-    for (unsigned int q = 0; q < n_quadrature_points_cell; ++q)
-    {
-      for (unsigned int c = 0; c < Equations<equationsType, dim>::n_components; ++c)
-        W_prev[q][c] = 0.;
+  QuadratureStates<Number>& states = quadrature_states(Number());
+  std::vector<std::array<Number, Equations<equationsType, dim>::n_components> >& W_prev = states.W_prev;
+  std::vector<std::array<std::array<Number, dim>, Equations<equationsType, dim>::n_components> >& fluxes_old = states.fluxes_old;
 
-      for (unsigned int i = 0; i < dofs_per_cell; ++i)
-      {
-        if (!is_primitive[i])
-        {
-          Tensor<1, dim> fe_v_value = fe_v_cell[mag].value(i, q);
-          for (unsigned int d = 0; d < dim; d++)
-            W_prev[q][5 + d] += prev_solution(dof_indices[i]) * fe_v_value[d];
-        }
-        else
-          W_prev[q][component_ii[i]] += prev_solution(dof_indices[i]) * fe_v_cell.shape_value(i, q);
-      }
-    }
-  }
+  // Now we calculate the previous values. For this we need to employ the previous FEValues
+  for (unsigned int q = 0; q < n_quadrature_points_cell; ++q)
+    evaluate_state(cellwise, values, fe_v_cell, q, cell_reduced, W_prev[q]);
 
   for (unsigned int i = 0; i < dofs_per_cell; ++i)
   {
+    if (skip_basis_fn(i, cell_reduced))
+      continue;
     double val = 0.;
     for (unsigned int q = 0; q < n_quadrature_points_cell; ++q)
     {
@@ -353,13 +605,15 @@ Problem<equationsType, dim>::assemble_cell_term(FullMatrix<double>& cell_matrix,
     cell_rhs(i) += val;
   }
 
-  //if (time_step_number > 0)
+  // Volumetric flux terms.
   {
     for (unsigned int q = 0; q < n_quadrature_points_cell; ++q)
       equations.compute_flux_matrix(W_prev[q], fluxes_old[q], this->parameters);
 
     for (unsigned int i = 0; i < dofs_per_cell; ++i)
     {
+      if (skip_basis_fn(i, cell_reduced))
+        continue;
       double val = 0.;
       for (unsigned int q = 0; q < n_quadrature_points_cell; ++q)
       {
@@ -377,113 +631,130 @@ Problem<equationsType, dim>::assemble_cell_term(FullMatrix<double>& cell_matrix,
               val += fe_v_cell.JxW(q) * parameters.current_time_step_length * fluxes_old[q][5 + d][e] * fe_v_grad[d][e];
         }
       }
-      if (std::isnan(val))
-      {
-        LOG(0, ": isnan: " << val);
-        LOG(0, ": i: " << i << ", ci: " << (!is_primitive[i] ? 1 : fe_v_cell.get_fe().system_to_component_index(i).first));
-        LOG(0, ": point: " << fe_v_cell.quadrature_point(0)[0] << ", " << fe_v_cell.quadrature_point(0)[1] << ", " << fe_v_cell.quadrature_point(0)[2]);
-        for (int j = 0; j < Equations<equationsType, dim>::n_components; j++)
-          LOGL(1, ": W [" << j << "]: " << (double)W_prev[0][j]);
-        exit(1);
-      }
       cell_rhs(i) += val;
     }
   }
 }
 
 template <EquationsType equationsType, int dim>
+template <typename Number>
 void
 Problem<equationsType, dim>::assemble_face_term(const unsigned int face_no, const FEFaceValuesBase<dim> &fe_v, const FEFaceValuesBase<dim> &fe_v_neighbor,
-  const bool external_face, const unsigned int boundary_id, Vector<double>& cell_rhs)
+  const bool external_face, const unsigned int boundary_id, Vector<double>& cell_rhs, const CellwiseSolution<dim, Number>& cellwise, const Number* values, const Number* values_neighbor)
 {
+  // The gradients are only used by the boundary conditions that depend on them (and only evaluated by fe_v_face_boundary if some does).
+  const bool evaluate_gradients = external_face && (boundary_conditions.dependencies(boundary_id) & BoundaryCondition<equationsType, dim>::depends_on_gradients);
+
+  QuadratureStates<Number>& states = quadrature_states(Number());
+  std::vector<std::array<Number, Equations<equationsType, dim>::n_components> >& Wplus_old = states.Wplus_old;
+  std::vector<std::array<Number, Equations<equationsType, dim>::n_components> >& Wminus_old = states.Wminus_old;
+  std::vector<std::array<Number, Equations<equationsType, dim>::n_components> >& normal_fluxes_old = states.normal_fluxes_old;
+
   // This loop is preparation - calculate all states (Wplus on the current element side of the currently assembled face, Wminus on the other side).
-  if (time_step_number == 0)
+  for (unsigned int q = 0; q < n_quadrature_points_face; ++q)
   {
-    initial_condition.vector_value(fe_v.get_quadrature_points(), Wplus_old);
+    evaluate_state(cellwise, values, fe_v, q, cell_reduced, Wplus_old[q]);
     if (!external_face)
-      for (unsigned int q = 0; q < n_quadrature_points_face; ++q)
-        for (unsigned int c = 0; c < Equations<equationsType, dim>::n_components; ++c)
-          Wminus_old[q][c] = Wplus_old[q][c];
-  }
-  else
-  {
-    for (unsigned int q = 0; q < n_quadrature_points_face; ++q)
+      evaluate_state(cellwise, values_neighbor, fe_v_neighbor, q, neighbor_reduced, Wminus_old[q]);
+    else
+      for (unsigned int c = 0; c < Equations<equationsType, dim>::n_components; ++c)
+        Wminus_old[q][c] = Number(0.);
+
+    if (evaluate_gradients)
     {
       for (unsigned int c = 0; c < Equations<equationsType, dim>::n_components; ++c)
-      {
-        Wplus_old[q][c] = Wminus_old[q][c] = 0.;
         for (int d = 0; d < dim; d++)
           Wgrad_plus_old[q][c][d] = 0.;
-      }
       for (unsigned int i = 0; i < dofs_per_cell; ++i)
       {
+        if (skip_basis_fn(i, cell_reduced))
+          continue;
+        const double value = values[cellwise.position(i)];
         if (!is_primitive[i])
         {
-          Tensor<1, dim> fe_v_value = fe_v[mag].value(i, q);
           Tensor<2, dim> fe_v_grad = fe_v[mag].gradient(i, q);
           for (int d = 0; d < dim; d++)
-          {
-            Wplus_old[q][5 + d] += prev_solution(dof_indices[i]) * fe_v_value[d];
             for (int e = 0; e < dim; e++)
-              Wgrad_plus_old[q][5 + d][e] += prev_solution(dof_indices[i]) * fe_v_grad[d][e];
-          }
+              Wgrad_plus_old[q][5 + d][e] += value * fe_v_grad[d][e];
         }
         else
-        {
-          Wplus_old[q][component_ii[i]] += prev_solution(dof_indices[i]) * fe_v.shape_value(i, q);
           for (int d = 0; d < dim; d++)
-            Wgrad_plus_old[q][component_ii[i]][d] += prev_solution(dof_indices[i]) * fe_v.shape_grad(i, q)[d];
-        }
-        if (!external_face)
-        {
-          if (!is_primitive[i])
-          {
-            Tensor<1, dim> fe_v_value_neighbor = fe_v_neighbor[mag].value(i, q);
-            for (int d = 0; d < dim; d++)
-              Wminus_old[q][5 + d] += prev_solution(dof_indices_neighbor[i]) * fe_v_value_neighbor[d];
-          }
-          else
-            Wminus_old[q][component_ii[i]] += prev_solution(dof_indices_neighbor[i]) * fe_v_neighbor.shape_value(i, q);
-        }
+            Wgrad_plus_old[q][component_ii[i]][d] += value * fe_v.shape_grad(i, q)[d];
       }
     }
   }
 
-  for (unsigned int q = 0; q < n_quadrature_points_face; ++q)
+  if (external_face)
   {
-    if (external_face)
-      boundary_conditions.bc_vector_value(boundary_id, fe_v.quadrature_point(q), fe_v.normal_vector(q), Wminus_old[q], Wgrad_plus_old[q], Wplus_old[q], this->time, this->cell);
+    // The boundary conditions are evaluated in double.
+    for (unsigned int q = 0; q < n_quadrature_points_face; ++q)
+      for (unsigned int c = 0; c < Equations<equationsType, dim>::n_components; ++c)
+      {
+        Wplus_boundary[q][c] = Wplus_old[q][c];
+        Wminus_boundary[q][c] = 0.;
+      }
+    if (boundary_conditions.dependencies(boundary_id) == 0)
+    {
+      std::vector<std::array<double, Equations<equationsType, dim>::n_components> >& cached_state = boundary_state_cache[cell->active_cell_index() * GeometryInfo<dim>::faces_per_cell + face_no];
+      if (cached_state.empty())
+      {
+        boundary_conditions.bc_vector_values(boundary_id, fe_v.get_quadrature_points(), fe_v.get_all_normal_vectors(), Wminus_boundary, Wgrad_plus_old, Wplus_boundary, this->time, this->cell);
+        cached_state = Wminus_boundary;
+      }
+      else
+        Wminus_boundary = cached_state;
+    }
+    else
+      boundary_conditions.bc_vector_values(boundary_id, fe_v.get_quadrature_points(), fe_v.get_all_normal_vectors(), Wminus_boundary, Wgrad_plus_old, Wplus_boundary, this->time, this->cell);
+    for (unsigned int q = 0; q < n_quadrature_points_face; ++q)
+      for (unsigned int c = 0; c < Equations<equationsType, dim>::n_components; ++c)
+        Wminus_old[q][c] = Wminus_boundary[q][c];
+  }
 
-    // Once we have the states on both sides of the face, we need to calculate the numerical flux.
+  // Once we have the states on both sides of the face, we need to calculate the numerical flux.
+  timing.start(timing_numerical_flux);
+  for (unsigned int q = 0; q < n_quadrature_points_face; ++q)
     this->numFlux->numerical_normal_flux(fe_v.normal_vector(q), Wplus_old[q], Wminus_old[q], normal_fluxes_old[q], max_signal_speed);
+  timing.stop(timing_numerical_flux);
 
-    // Some debugging outputs.
-    if ((parameters.debug & parameters.Assembling) || (parameters.debug & parameters.NumFlux))
+  // Jumps for the adaptivity indicator (not in the first step - its initial refinements use Adaptivity::calculate_jumps() of the solution).
+  // Periodic faces are skipped, as in Adaptivity::calculate_jumps(), so that both give the same indicator.
+  if (!external_face && (time_step_number > 0) && !parameters.assembly_indicator_components.empty() && !cell->face(face_no)->at_boundary())
+  {
+    std::array<double, dim>& jump = assembly_jumps[cell->active_cell_index()];
+    std::array<double, dim>& area = assembly_areas[cell->active_cell_index()];
+    for (unsigned int q = 0; q < n_quadrature_points_face; ++q)
     {
-      LOG(0, "point_i: " << q);
-
-      LOG(1, "q: " << fe_v.quadrature_point(q) << ", n: " << fe_v.normal_vector(q)[0] << ", " << fe_v.normal_vector(q)[1] << ", " << fe_v.normal_vector(q)[2]);
-      LOG(1, "Wplus: ");
-      for (unsigned int i = 0; i < Equations<equationsType, dim>::n_components; i++)
-        LOG(0, Wplus_old[q][i] << (i < 7 ? ", " : ""));
-
-      LOG(1, "Wminus: ");
-      for (unsigned int i = 0; i < Equations<equationsType, dim>::n_components; i++)
-        LOG(0, Wminus_old[q][i] << (i < 7 ? ", " : ""));
+      area[face_no / 2] += fe_v.JxW(q);
+      for (unsigned int i = 0; i < parameters.assembly_indicator_components.size(); ++i)
+        jump[face_no / 2] += std::fabs(Wplus_old[q][parameters.assembly_indicator_components[i]] - Wminus_old[q][parameters.assembly_indicator_components[i]]) * fe_v.JxW(q);
+    }
+  }
 
-      LOG(1, "Num F: ");
+  // Some debugging outputs.
+  if (DEBUG_FLAG_SET(parameters, Assembling) || DEBUG_FLAG_SET(parameters, NumFlux))
+  {
+    for (unsigned int q = 0; q < n_quadrature_points_face; ++q)
+    {
+      std::stringstream ss_plus, ss_minus, ss_flux;
       for (unsigned int i = 0; i < Equations<equationsType, dim>::n_components; i++)
       {
-        LOG(0, normal_fluxes_old[q][i] << (i < 7 ? ", " : ""));
-        if ((i + 1) == Equations<equationsType, dim>::n_components)
-          std::cout << std::endl;
+        const char* separator = (i + 1 < Equations<equationsType, dim>::n_components ? ", " : "");
+        ss_plus << Wplus_old[q][i] << separator;
+        ss_minus << Wminus_old[q][i] << separator;
+        ss_flux << normal_fluxes_old[q][i] << separator;
       }
+      LOGL(0, "point_i: " << q);
+      LOGL(1, "q: " << fe_v.quadrature_point(q) << ", n: " << fe_v.normal_vector(q)[0] << ", " << fe_v.normal_vector(q)[1] << ", " << fe_v.normal_vector(q)[2]);
+      LOGL(1, "Wplus: " << ss_plus.str());
+      LOGL(1, "Wminus: " << ss_minus.str());
+      LOGL(1, "Num F: " << ss_flux.str());
     }
   }
 
   for (unsigned int i = 0; i < dofs_per_cell; ++i)
   {
-    if (fe_v.get_fe().has_support_on_face(i, face_no))
+    if (fe_v.get_fe().has_support_on_face(i, face_no) && !skip_basis_fn(i, cell_reduced))
     {
       double val = 0.;
       for (unsigned int q = 0; q < n_quadrature_points_face; ++q)
@@ -496,17 +767,6 @@ Problem<equationsType, dim>::assemble_face_term(const unsigned int face_no, cons
         else
           val += this->parameters.current_time_step_length * normal_fluxes_old[q][component_ii[i]] * fe_v.shape_value(i, q) * fe_v.JxW(q);
 
-        if (std::isnan(val))
-        {
-          numFlux->numerical_normal_flux(fe_v.normal_vector(q), Wplus_old[q], Wminus_old[q], normal_fluxes_old[q], max_signal_speed);
-          LOG(0, ": isnan: " << val);
-          LOG(0, ": i: " << i << ", ci: " << (!is_primitive[i] ? 1 : fe_v.get_fe().system_to_component_index(i).first));
-          LOG(0, ": point: " << fe_v.quadrature_point(q)[0] << ", " << fe_v.quadrature_point(q)[1] << ", " << fe_v.quadrature_point(q)[2]);
-          LOG(0, ": normal: " << fe_v.normal_vector(q)[0] << ", " << fe_v.normal_vector(q)[1] << ", " << fe_v.normal_vector(q)[2]);
-          for (int j = 0; j < Equations<equationsType, dim>::n_components; j++)
-            LOGL(1, ": W+ [" << j << "]: " << (double)Wplus_old[q][j] << ", W- [" << j << "]: " << (double)Wminus_old[q][j] << ", F [" << j << "]: " << (double)normal_fluxes_old[q][j]);
-          exit(1);
-        }
       }
 
       cell_rhs(i) -= val;
@@ -518,6 +778,23 @@ template <EquationsType equationsType, int dim>
 void
 Problem<equationsType, dim>::solve()
 {
+  if (this->diagonal_mass_matrix)
+  {
+    if (this->reset_after_refinement)
+    {
+      inverse_mass_diagonal.reinit(locally_owned_dofs, mpi_communicator);
+      for (IndexSet::ElementIterator it = locally_owned_dofs.begin(); it != locally_owned_dofs.end(); ++it)
+        inverse_mass_diagonal(*it) = 1. / system_matrix.diag_element(*it);
+      inverse_mass_diagonal.compress(VectorOperation::insert);
+    }
+
+    // The rhs is not needed any more (zeroed before the next assembly), so it becomes the solution.
+    current_limited_solution.swap(system_rhs);
+    current_limited_solution.scale(inverse_mass_diagonal);
+    constraints.distribute(current_limited_solution);
+    return;
+  }
+
   // Direct solver is only usable without MPI, as it is not distributed.
 #ifndef HAVE_MPI
   if (parameters.solver == parameters.direct)
@@ -525,7 +802,8 @@ Problem<equationsType, dim>::solve()
     SolverControl solver_control(1, 0);
     TrilinosWrappers::SolverDirect::AdditionalData data(parameters.output == Parameters<dim>::verbose_solver);
     TrilinosWrappers::SolverDirect direct(solver_control, data);
-    direct.solve(system_matrix, current_unlimited_solution, system_rhs);
+    direct.solve(system_matrix, current_limited_solution, system_rhs);
+    constraints.distribute(current_limited_solution);
     return;
   }
   else
@@ -537,9 +815,8 @@ Problem<equationsType, dim>::solve()
       solver = new AztecOO();
     }
 
-    dealii::LinearAlgebraTrilinos::MPI::Vector completely_distributed_solution(locally_owned_dofs, mpi_communicator);
-
-    Epetra_Vector x(View, system_matrix.trilinos_matrix().DomainMap(), completely_distributed_solution.begin());
+    // The initial guess is the solution of the previous time step (zero after refinement).
+    Epetra_Vector x(View, system_matrix.trilinos_matrix().DomainMap(), current_limited_solution.begin());
     Epetra_Vector b(View, system_matrix.trilinos_matrix().RangeMap(), system_rhs.begin());
 
     solver->SetAztecOption(AZ_output, (parameters.output == Parameters<dim>::quiet_solver ? AZ_none : AZ_all));
@@ -560,11 +837,78 @@ Problem<equationsType, dim>::solve()
 
     solver->Iterate(parameters.max_iterations, parameters.linear_residual);
 
-    constraints.distribute(completely_distributed_solution);
-    current_unlimited_solution = completely_distributed_solution;
+    constraints.distribute(current_limited_solution);
   }
 }
 
+template <EquationsType equationsType, int dim>
+Problem<equationsType, dim>::ProjectionScratchData::ProjectionScratchData(const Mapping<dim>& mapping, const FiniteElement<dim>& fe, const Quadrature<dim>& quadrature) :
+  fe_v(mapping, fe, quadrature, update_values | update_JxW_values | update_quadrature_points),
+  W(quadrature.size()),
+  mass_matrix(fe.dofs_per_cell, fe.dofs_per_cell),
+  rhs(fe.dofs_per_cell)
+{
+}
+
+template <EquationsType equationsType, int dim>
+Problem<equationsType, dim>::ProjectionScratchData::ProjectionScratchData(const ProjectionScratchData& scratch) :
+  fe_v(scratch.fe_v.get_mapping(), scratch.fe_v.get_fe(), scratch.fe_v.get_quadrature(), scratch.fe_v.get_update_flags()),
+  W(scratch.W.size()),
+  mass_matrix(scratch.mass_matrix.m(), scratch.mass_matrix.n()),
+  rhs(scratch.rhs.size())
+{
+}
+
+template <EquationsType equationsType, int dim>
+void Problem<equationsType, dim>::projection_worker(const typename DoFHandler<dim>::active_cell_iterator& cell, ProjectionScratchData& scratch, ProjectionCopyData& copy_data) const
+{
+  scratch.fe_v.reinit(cell);
+  const unsigned int n_q_points = scratch.fe_v.n_quadrature_points, n_dofs = scratch.fe_v.dofs_per_cell;
+  initial_condition.vector_value(scratch.fe_v.get_quadrature_points(), scratch.W);
+
+  // The shape functions are vector-valued (the div-free ones non-primitive), so all components are integrated.
+  scratch.mass_matrix = 0.;
+  scratch.rhs = 0.;
+  for (unsigned int q = 0; q < n_q_points; ++q)
+    for (unsigned int c = 0; c < Equations<equationsType, dim>::n_components; ++c)
+      for (unsigned int i = 0; i < n_dofs; ++i)
+      {
+        const double value_i = scratch.fe_v.shape_value_component(i, q, c) * scratch.fe_v.JxW(q);
+        if (value_i == 0.)
+          continue;
+        scratch.rhs(i) += value_i * scratch.W[q][c];
+        for (unsigned int j = 0; j < n_dofs; ++j)
+          scratch.mass_matrix(i, j) += value_i * scratch.fe_v.shape_value_component(j, q, c);
+      }
+  scratch.mass_matrix.gauss_jordan();
+
+  copy_data.dof_indices.resize(n_dofs);
+  cell->get_dof_indices(copy_data.dof_indices);
+  copy_data.coefficients.reinit(n_dofs);
+  scratch.mass_matrix.vmult(copy_data.coefficients, scratch.rhs);
+}
+
+template <EquationsType equationsType, int dim>
+void Problem<equationsType, dim>::projection_copier(const ProjectionCopyData& copy_data)
+{
+  for (unsigned int i = 0; i < copy_data.dof_indices.size(); ++i)
+    current_limited_solution(copy_data.dof_indices[i]) = copy_data.coefficients(i);
+}
+
+template <EquationsType equationsType, int dim>
+void Problem<equationsType, dim>::project_initial_condition()
+{
+  typedef FilteredIterator<typename DoFHandler<dim>::active_cell_iterator> LocallyOwnedCellIterator;
+  WorkStream::run(LocallyOwnedCellIterator(IteratorFilters::LocallyOwnedCell(), dof_handler.begin_active()), LocallyOwnedCellIterator(IteratorFilters::LocallyOwnedCell(), dof_handler.end()),
+    std::bind(&Problem<equationsType, dim>::projection_worker, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3),
+    std::bind(&Problem<equationsType, dim>::projection_copier, this, std::placeholders::_1),
+    ProjectionScratchData(mapping, fe, quadrature), ProjectionCopyData());
+  current_limited_solution.compress(VectorOperation::insert);
+  constraints.distribute(current_limited_solution);
+
+  this->prev_solution = current_limited_solution;
+}
+
 template <EquationsType equationsType, int dim>
 void Problem<equationsType, dim>::output_base()
 {
@@ -648,6 +992,144 @@ void Problem<equationsType, dim>::output_results(bool use_prev_solution) const
   ++output_file_number;
 }
 
+template <EquationsType equationsType, int dim>
+void Problem<equationsType, dim>::output_slices() const
+{
+  static unsigned int output_slice_number = 0;
+
+  const std::string filename_prefix = (parameters.output_file_prefix.length() > 0 ? parameters.output_file_prefix : "solution") + "-slice-";
+
+  for (unsigned int i = 0; i < parameters.output_planes.size(); ++i)
+  {
+    std::vector<unsigned int> fixed_directions(1, parameters.output_planes[i].first);
+    std::vector<double> fixed_positions(1, parameters.output_planes[i].second);
+    output_slice<dim - 1>(fixed_directions, fixed_positions, filename_prefix + "plane-" + Utilities::int_to_string(i) + "-" + Utilities::int_to_string(output_slice_number, 3));
+  }
+
+  for (unsigned int i = 0; i < parameters.output_lines.size(); ++i)
+  {
+    std::vector<unsigned int> fixed_directions;
+    std::vector<double> fixed_positions;
+    for (unsigned int d = 0; d < dim; ++d)
+    {
+      if (d == parameters.output_lines[i].first)
+        continue;
+      fixed_directions.push_back(d);
+      fixed_positions.push_back(parameters.output_lines[i].second[fixed_directions.size() - 1]);
+    }
+    output_slice<1>(fixed_directions, fixed_positions, filename_prefix + "line-" + Utilities::int_to_string(i) + "-" + Utilities::int_to_string(output_slice_number, 3));
+  }
+
+  ++output_slice_number;
+}
+
+template <EquationsType equationsType, int dim>
+template <int slice_dim>
+void Problem<equationsType, dim>::output_slice(const std::vector<unsigned int>& fixed_directions, const std::vector<double>& fixed_positions, const std::string& filename_base) const
+{
+  // Directions spanning the slice, in ascending order.
+  std::vector<unsigned int> free_directions;
+  for (unsigned int d = 0; d < dim; ++d)
+    if (std::find(fixed_directions.begin(), fixed_directions.end(), d) == fixed_directions.end())
+      free_directions.push_back(d);
+  Assert(free_directions.size() == slice_dim, ExcInternalError());
+
+  const unsigned int n_subdivisions = std::max(1u, parameters.patches);
+  const unsigned int n_points_1d = n_subdivisions + 1;
+  const unsigned int n_points = Utilities::fixed_power<slice_dim>(n_points_1d);
+
+  std::vector<Point<dim> > unit_points(n_points);
+  std::vector<Vector<double> > values(n_points, Vector<double>(Equations<equationsType, dim>::n_components));
+  std::vector<DataOutBase::Patch<slice_dim, dim> > patches;
+
+  for (typename DoFHandler<dim>::active_cell_iterator slice_cell = dof_handler.begin_active(); slice_cell != dof_handler.end(); ++slice_cell)
+  {
+    if (!slice_cell->is_locally_owned())
+      continue;
+
+    // Cells are axis-aligned boxes - the first vertex is the lower, the last one the upper corner.
+    const Point<dim> lower = slice_cell->vertex(0);
+    const Point<dim> upper = slice_cell->vertex(GeometryInfo<dim>::vertices_per_cell - 1);
+
+    // A slice lying on an interface between two cells belongs to the upper one, unless it is on the (upper) domain boundary.
+    bool intersects = true;
+    for (unsigned int i = 0; i < fixed_directions.size(); ++i)
+    {
+      const unsigned int d = fixed_directions[i];
+      if ((fixed_positions[i] < lower[d]) || (fixed_positions[i] > upper[d]) || ((fixed_positions[i] == upper[d]) && !slice_cell->at_boundary(2 * d + 1)))
+        intersects = false;
+    }
+    if (!intersects)
+      continue;
+
+    // Points of the slice in the unit cell, lexicographically ordered as DataOutBase expects.
+    for (unsigned int point = 0; point < n_points; ++point)
+    {
+      unsigned int index = point;
+      for (unsigned int i = 0; i < slice_dim; ++i)
+      {
+        unit_points[point][free_directions[i]] = (double)(index % n_points_1d) / n_subdivisions;
+        index /= n_points_1d;
+      }
+      for (unsigned int i = 0; i < fixed_directions.size(); ++i)
+        unit_points[point][fixed_directions[i]] = (fixed_positions[i] - lower[fixed_directions[i]]) / (upper[fixed_directions[i]] - lower[fixed_directions[i]]);
+    }
+
+    FEValues<dim> fe_v_slice(mapping, fe, Quadrature<dim>(unit_points, std::vector<double>(n_points, 1. / n_points)), update_values | update_quadrature_points);
+    fe_v_slice.reinit(slice_cell);
+    fe_v_slice.get_function_values(current_limited_solution, values);
+
+    DataOutBase::Patch<slice_dim, dim> patch;
+    for (unsigned int vertex = 0; vertex < GeometryInfo<slice_dim>::vertices_per_cell; ++vertex)
+    {
+      for (unsigned int i = 0; i < slice_dim; ++i)
+        patch.vertices[vertex][free_directions[i]] = (vertex & (1 << i)) ? upper[free_directions[i]] : lower[free_directions[i]];
+      for (unsigned int i = 0; i < fixed_directions.size(); ++i)
+        patch.vertices[vertex][fixed_directions[i]] = fixed_positions[i];
+    }
+    patch.n_subdivisions = n_subdivisions;
+    patch.patch_index = patches.size();
+    patch.data.reinit(Equations<equationsType, dim>::n_components, n_points);
+    for (unsigned int c = 0; c < Equations<equationsType, dim>::n_components; ++c)
+      for (unsigned int point = 0; point < n_points; ++point)
+        patch.data(c, point) = values[point][c];
+    patches.push_back(patch);
+  }
+
+  // Names and vector ranges, the same as in output_results().
+  const std::vector<std::string> data_names = equations.component_names();
+  const std::vector<DataComponentInterpretation::DataComponentInterpretation> interpretation = equations.component_interpretation();
+  std::vector<std::tuple<unsigned int, unsigned int, std::string> > vector_data_ranges;
+  for (unsigned int c = 0; c < interpretation.size(); ++c)
+  {
+    if (interpretation[c] != DataComponentInterpretation::component_is_part_of_vector)
+      continue;
+    unsigned int last = c;
+    while ((last + 1 < interpretation.size()) && (interpretation[last + 1] == DataComponentInterpretation::component_is_part_of_vector) && (data_names[last + 1] == data_names[c]))
+      ++last;
+    vector_data_ranges.push_back(std::tuple<unsigned int, unsigned int, std::string>(c, last, data_names[c]));
+    c = last;
+  }
+
+#ifdef HAVE_MPI
+  std::ofstream output_vtu((filename_base + "-" + Utilities::int_to_string(triangulation.locally_owned_subdomain(), 4) + ".vtu").c_str());
+  DataOutBase::write_vtu(patches, data_names, vector_data_ranges, DataOutBase::VtkFlags(), output_vtu);
+
+  if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+  {
+    std::vector<std::string> filenames;
+    for (unsigned int i = 0; i < Utilities::MPI::n_mpi_processes(mpi_communicator); ++i)
+      filenames.push_back(filename_base + "-" + Utilities::int_to_string(i, 4) + ".vtu");
+
+    std::ofstream pvtu_master_output((filename_base + ".pvtu").c_str());
+    DataOutBase::write_pvtu_record(pvtu_master_output, filenames, data_names, vector_data_ranges);
+  }
+#else
+  std::ofstream output_vtu((filename_base + ".vtu").c_str());
+  DataOutBase::write_vtu(patches, data_names, vector_data_ranges, DataOutBase::VtkFlags(), output_vtu);
+#endif
+}
+
 template <EquationsType equationsType, int dim>
 void Problem<equationsType, dim>::output_matrix(TrilinosWrappers::SparseMatrix& mat, const char* suffix) const
 {
@@ -670,6 +1152,106 @@ void Problem<equationsType, dim>::output_vector(TrilinosWrappers::MPI::Vector& v
   n.close();
 }
 
+template <EquationsType equationsType, int dim>
+void Problem<equationsType, dim>::check_finite(const TrilinosWrappers::MPI::Vector& vec, const char* stage)
+{
+  // x * 0 is 0 for finite x and NaN otherwise, so the sum tests all local entries without branching.
+  double test = 0.;
+  for (TrilinosWrappers::MPI::Vector::const_iterator it = vec.begin(); it != vec.end(); ++it)
+    test += (*it) * 0.;
+  const unsigned int local_failure = std::isfinite(test) ? 0 : 1;
+  if (Utilities::MPI::max(local_failure, mpi_communicator) == 0)
+    return;
+
+  std::stringstream filename;
+  filename << parameters.output_file_prefix << "nonfinite-" << time_step_number << "-" << Utilities::MPI::this_mpi_process(mpi_communicator) << ".txt";
+  if (local_failure)
+  {
+    // Diagnostic checkpoint - all cells with a non-finite value, with their previous states and the previous states of their neighbors.
+    std::ofstream out(filename.str().c_str());
+    out << "Non-finite values after " << stage << ", step: " << time_step_number << ", T: " << time << ", time step: " << parameters.current_time_step_length << std::endl;
+    std::vector<types::global_dof_index> cell_dof_indices(dofs_per_cell), neighbor_dof_indices(dofs_per_cell);
+    for (typename DoFHandler<dim>::active_cell_iterator c = dof_handler.begin_active(); c != dof_handler.end(); ++c)
+    {
+      if (!c->is_locally_owned())
+        continue;
+      c->get_dof_indices(cell_dof_indices);
+      bool cell_failure = false;
+      for (unsigned int i = 0; i < dofs_per_cell; ++i)
+        if (!std::isfinite(vec(cell_dof_indices[i])))
+          cell_failure = true;
+      if (!cell_failure)
+        continue;
+
+      out << "cell: " << c->id() << ", center: " << c->center() << ", diameter: " << c->diameter() << std::endl;
+      out << "  values:";
+      for (unsigned int i = 0; i < dofs_per_cell; ++i)
+        out << " " << vec(cell_dof_indices[i]);
+      out << std::endl << "  previous state:";
+      for (unsigned int i = 0; i < dofs_per_cell; ++i)
+        out << " " << prev_solution(cell_dof_indices[i]);
+      out << std::endl;
+      for (unsigned int face_no = 0; face_no < GeometryInfo<dim>::faces_per_cell; ++face_no)
+      {
+        out << "  face " << face_no << ": ";
+        if (c->at_boundary(face_no) && !(this->parameters.is_periodic_boundary(c->face(face_no)->boundary_id())))
+          out << "boundary " << (int)c->face(face_no)->boundary_id() << std::endl;
+        else
+        {
+          const typename DoFHandler<dim>::cell_iterator neighbor = c->neighbor_or_periodic_neighbor(face_no);
+          out << "neighbor " << neighbor->id() << ", center: " << neighbor->center();
+          if (neighbor->has_children())
+            out << " (refined)" << std::endl;
+          else
+          {
+            neighbor->get_dof_indices(neighbor_dof_indices);
+            out << ", previous state:";
+            for (unsigned int i = 0; i < dofs_per_cell; ++i)
+              out << " " << prev_solution(neighbor_dof_indices[i]);
+            out << std::endl;
+          }
+        }
+      }
+    }
+  }
+
+  LogSink::instance().flush();
+  AssertThrow(false, ExcMessage(std::string("Non-finite values after ") + stage + " in step " + Utilities::int_to_string(time_step_number)
+    + ", see " + parameters.output_file_prefix + "nonfinite-" + Utilities::int_to_string(time_step_number) + "-*.txt"));
+}
+
+template <EquationsType equationsType, int dim>
+void Problem<equationsType, dim>::refine_initial_mesh()
+{
+  int refinement_step = 0;
+  while (true)
+  {
+    {
+      TimingScope<dim> timing_scope(timing, timing_initial_condition);
+      project_initial_condition();
+    }
+
+    // The adaptivity counts the Parameters::perform_n_initial_refinements refinements of time step 0 on its own.
+    timing.start(timing_refinement);
+    if (!this->adaptivity->refine_mesh(0, time, prev_solution, dof_handler, triangulation, mapping))
+    {
+      timing.stop(timing_refinement);
+      break;
+    }
+    triangulation.execute_coarsening_and_refinement();
+    timing.stop(timing_refinement);
+
+    this->setup_system();
+    current_limited_solution.reinit(locally_owned_dofs, mpi_communicator);
+    current_unlimited_solution.reinit(locally_relevant_dofs, mpi_communicator);
+    prev_solution.reinit(locally_relevant_dofs, mpi_communicator);
+    this->perform_reset_after_refinement();
+
+    if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
+      LOGL(0, "Initial refinement: " << ++refinement_step << ", number of active cells: " << triangulation.n_global_active_cells());
+  }
+}
+
 template <EquationsType equationsType, int dim>
 void Problem<equationsType, dim>::run()
 {
@@ -684,8 +1266,19 @@ void Problem<equationsType, dim>::run()
   exit(1);
 #endif
 
+  // The first step starts from the projection of the initial condition (on the initial mesh refined for it).
+  if (this->parameters.debug & this->parameters.BasicSteps)
+    LOGL(1, "Projecting the initial condition...")
+  if (this->adaptivity)
+    refine_initial_mesh();
+  else
+  {
+    TimingScope<dim> timing_scope(timing, timing_initial_condition);
+    project_initial_condition();
+  }
+
   int adaptivity_step = 0;
-  while (time < parameters.final_time)
+  while ((time < parameters.final_time) && ((parameters.max_time_steps <= 0) || (time_step_number < parameters.max_time_steps)))
   {
     // Some output.
     if (Utilities::MPI::this_mpi_process(mpi_communicator) == 0)
@@ -697,10 +1290,14 @@ void Problem<equationsType, dim>::run()
     // Assemble
     if (this->parameters.debug & this->parameters.BasicSteps)
       LOGL(1, "Assembling...")
+    {
+      TimingScope<dim> timing_scope(timing, timing_assemble);
       system_rhs = 0;
-    if (reset_after_refinement)
-      system_matrix = 0;
-    assemble_system(this->reset_after_refinement);
+      if (reset_after_refinement)
+        system_matrix = 0;
+      assemble_system(this->reset_after_refinement);
+    }
+    check_finite(system_rhs, "assembling");
 
     // Output matrix & rhs if required.
     if (parameters.output_matrix)
@@ -711,32 +1308,114 @@ void Problem<equationsType, dim>::run()
     // Solve
     if (this->parameters.debug & this->parameters.BasicSteps)
       LOGL(1, "Solving...")
+    {
+      TimingScope<dim> timing_scope(timing, timing_solve);
       solve();
+      current_unlimited_solution = current_limited_solution;
+    }
+    check_finite(current_unlimited_solution, "solving");
 
     // Postprocess if required
+    this->solution_limited = false;
     if ((this->time >= this->parameters.start_limiting_at) && parameters.limit && parameters.polynomial_order_dg > 0)
     {
       if (this->parameters.debug & this->parameters.BasicSteps)
         LOGL(1, "Postprocessing...")
+      {
+        TimingScope<dim> timing_scope(timing, timing_limiter);
         postprocess();
+      }
+      check_finite(current_limited_solution, "limiting");
     }
-    else
-      current_limited_solution = current_unlimited_solution;
 
     move_time_step_handle_outputs();
   }
+
+  LogSink::instance().flush();
+  timing.finish(time_step_number);
 }
 
 template <EquationsType equationsType, int dim>
 void Problem<equationsType, dim>::perform_reset_after_refinement()
 {
   this->reset_after_refinement = true;
+  this->imbalanced_checks = 0;
   this->slopeLimiter->flush_cache();
+  // Active cell indices change with refinement.
+  this->boundary_state_cache.clear();
+}
+
+template <EquationsType equationsType, int dim>
+unsigned int Problem<equationsType, dim>::cell_weight(const typename Triangulation<dim>::cell_iterator& cell, const typename Triangulation<dim>::CellStatus status) const
+{
+  if (this->average_cell_cost <= 0.)
+    return 0;
+
+  // Cells to be coarsened are passed as the parent - their children are averaged. Cells to be refined pass their cost to each child.
+  double cost = 0.;
+  if (cell->active())
+    cost = this->cell_costs[cell->active_cell_index()];
+  else
+  {
+    for (unsigned int child = 0; child < cell->n_children(); ++child)
+      if (cell->child(child)->active())
+        cost += this->cell_costs[cell->child(child)->active_cell_index()] / cell->n_children();
+  }
+
+  // Every cell has the weight 1000 to start with.
+  return (unsigned int)std::max(0., 1000. * (cost / this->average_cell_cost - 1.));
+}
+
+template <EquationsType equationsType, int dim>
+void Problem<equationsType, dim>::repartition_if_imbalanced()
+{
+#ifdef HAVE_MPI
+  double local_cost = 0.;
+  for (unsigned int i = 0; i < this->cell_costs.size(); ++i)
+    local_cost += this->cell_costs[i];
+  const Utilities::MPI::MinMaxAvg process_cost = Utilities::MPI::min_max_avg(local_cost, mpi_communicator);
+  this->average_cell_cost = Utilities::MPI::sum(local_cost, mpi_communicator) / triangulation.n_global_active_cells();
+
+  if ((process_cost.avg <= 0.) || (process_cost.max <= parameters.repartition_imbalance_threshold * process_cost.avg))
+  {
+    this->imbalanced_checks = 0;
+    return;
+  }
+  // A single imbalanced check may be noise (or a transient of the flow), repartitioning forces reassembly of the matrix.
+  if (++this->imbalanced_checks < parameters.repartition_imbalanced_checks)
+    return;
+
+  if (this->parameters.debug & this->parameters.BasicSteps)
+    LOGL(1, "Repartitioning, process cost max / avg: " << process_cost.max / process_cost.avg);
+
+  timing.start(timing_refinement);
+  parallel::distributed::SolutionTransfer<dim, TrilinosWrappers::MPI::Vector> soltrans(dof_handler);
+  soltrans.prepare_for_coarsening_and_refinement(prev_solution);
+  triangulation.repartition();
+  timing.stop(timing_refinement);
+
+  timing.start(timing_solution_transfer);
+  this->setup_system();
+  current_limited_solution.reinit(locally_owned_dofs, mpi_communicator);
+  current_unlimited_solution.reinit(locally_relevant_dofs, mpi_communicator);
+  TrilinosWrappers::MPI::Vector interpolated_solution;
+  interpolated_solution.reinit(locally_owned_dofs, mpi_communicator);
+  soltrans.interpolate(interpolated_solution);
+  prev_solution.reinit(locally_relevant_dofs, mpi_communicator);
+  this->prev_solution = interpolated_solution;
+  timing.stop(timing_solution_transfer);
+
+  this->perform_reset_after_refinement();
+#endif
 }
 
 template <EquationsType equationsType, int dim>
 void Problem<equationsType, dim>::move_time_step_handle_outputs()
 {
+  // The length of the step just solved - calculate_cfl_condition() sets the next one.
+  const double solved_time_step_length = parameters.current_time_step_length;
+
+  timing.start(timing_output);
   if (parameters.output_solution)
     output_vector(current_limited_solution, "solution");
 
@@ -748,16 +1427,24 @@ void Problem<equationsType, dim>::move_time_step_handle_outputs()
   
  if (time_step_number<=1) output_results();
 
+  if ((parameters.output_planes.size() + parameters.output_lines.size() > 0) && ((parameters.output_slices_step < 0) || (time - last_slice_output_time >= parameters.output_slices_step)))
+  {
+    output_slices();
+    last_slice_output_time = time;
+  }
+  timing.stop(timing_output);
 
   if (time_step_number > 0)
 
   {
+	 TimingScope<dim> timing_scope(timing, timing_cfl);
 	 calculate_cfl_condition();
 	 double global_cfl_time_step = Utilities::MPI::min(this->cfl_time_step, mpi_communicator);
 	 parameters.current_time_step_length = global_cfl_time_step;
   }
 
-  if (this->adaptivity)
+  // The initial mesh is refined by refine_initial_mesh().
+  if (this->adaptivity && (time_step_number > 0))
   {
     // refine mesh
     // we use the unlimited solution here for two reasons:
@@ -765,7 +1452,8 @@ void Problem<equationsType, dim>::move_time_step_handle_outputs()
     // - it is a useful indicator where to refine
     if (this->parameters.debug & this->parameters.BasicSteps)
       LOGL(1, "Refining...")
-      bool refined = this->adaptivity->refine_mesh(time_step_number, time, current_unlimited_solution, dof_handler, triangulation, mapping);
+    timing.start(timing_refinement);
+    bool refined = this->adaptivity->refine_mesh(time_step_number, time, current_unlimited_solution, dof_handler, triangulation, mapping);
     if (refined)
     {
       // transfer solution
@@ -775,11 +1463,12 @@ void Problem<equationsType, dim>::move_time_step_handle_outputs()
       SolutionTransfer<dim, TrilinosWrappers::MPI::Vector> soltrans(dof_handler);
 #endif
 
-      if (time_step_number > 0)
-        soltrans.prepare_for_coarsening_and_refinement(prev_solution);
+      soltrans.prepare_for_coarsening_and_refinement(prev_solution);
 
       // Refine the current triangulation.
       triangulation.execute_coarsening_and_refinement();
+      timing.stop(timing_refinement);
+      timing.start(timing_solution_transfer);
 
       // reinit structures, periodicity, etc.
       this->setup_system();
@@ -788,38 +1477,52 @@ void Problem<equationsType, dim>::move_time_step_handle_outputs()
       current_unlimited_solution.reinit(locally_relevant_dofs, mpi_communicator);
 
       // Now interpolate the solution
-      if (time_step_number > 0)
-      {
-        TrilinosWrappers::MPI::Vector interpolated_solution;
-        interpolated_solution.reinit(locally_owned_dofs, mpi_communicator);
+      TrilinosWrappers::MPI::Vector interpolated_solution;
+      interpolated_solution.reinit(locally_owned_dofs, mpi_communicator);
 #ifdef HAVE_MPI
-        soltrans.interpolate(interpolated_solution);
+      soltrans.interpolate(interpolated_solution);
 #else
-        soltrans.interpolate(prev_solution, interpolated_solution);
+      soltrans.interpolate(prev_solution, interpolated_solution);
 #endif
-        prev_solution.reinit(locally_relevant_dofs, mpi_communicator);
-        this->prev_solution = interpolated_solution;
-      }
-      else
-        prev_solution.reinit(locally_relevant_dofs, mpi_communicator);
+      prev_solution.reinit(locally_relevant_dofs, mpi_communicator);
+      this->prev_solution = interpolated_solution;
+      timing.stop(timing_solution_transfer);
 
       this->perform_reset_after_refinement();
     }
     else
     {
+      timing.stop(timing_refinement);
       this->reset_after_refinement = false;
-      this->prev_solution = this->current_limited_solution;
+      this->advance_solution();
       ++time_step_number;
-      time += parameters.current_time_step_length;
+      time += solved_time_step_length;
     }
   }
   else
   {
     this->reset_after_refinement = false;
-    this->prev_solution = this->current_limited_solution;
+    this->advance_solution();
     ++time_step_number;
-    time += parameters.current_time_step_length;
+    time += solved_time_step_length;
   }
+
+  // The last step is shortened to end at the final time (the sum of the steps differs from it by the round-off).
+  if (!this->reset_after_refinement && (std::abs(parameters.final_time - time) <= 1e-12 * std::abs(parameters.final_time)))
+    time = parameters.final_time;
+  if (time < parameters.final_time)
+    parameters.current_time_step_length = std::min(parameters.current_time_step_length, parameters.final_time - time);
+
+  // Refinement repartitions (weighted) on its own.
+  if ((parameters.repartition_imbalance_threshold > 0.) && !this->reset_after_refinement && (time_step_number % parameters.repartition_check_every_nth_time_step == 0))
+    repartition_if_imbalanced();
+
+  // Refinement resets the degrees.
+  if (parameters.p0_reduction && (parameters.polynomial_order_dg > 0) && !this->reset_after_refinement)
+    update_cell_degrees();
+
+  timing.end_time_step(time_step_number);
+  LogSink::instance().flush();
 }
 
 template class Problem<EquationsTypeMhd, 3>;
@@ -4,10 +4,12 @@
 #include "initialCondition.h"
 #include "boundaryCondition.h"
 #include "feDivFree.h"
-#include "feTaylor.h"
+#include "feLegendreCartesian.h"
 #include "numericalFlux.h"
 #include "slopeLimiter.h"
 #include "adaptivity.h"
+#include "timing.h"
+#include "cellwiseSolution.h"
 
 // Class that accepts all input from the user, provides interface for output, etc.
 // Should not be changed.
@@ -30,6 +32,7 @@ public:
   // Performs a single global assembly.
   void assemble_system(bool assemble_matrix = true);
 
+  // Limits current_limited_solution in place (current_unlimited_solution is its ghosted copy the limiter reads).
   void postprocess();
   
   void set_adaptivity(Adaptivity<dim>* adaptivity);
@@ -37,26 +40,99 @@ public:
   // Performs a single global assembly.
   void calculate_cfl_condition();
 
-  // Performs a local assembly for all volumetric contributions on the local cell.
-  void assemble_cell_term(FullMatrix<double>& cell_matrix, Vector<double>& cell_rhs, bool assemble_matrix);
+  // The length the CFL condition uses - the minimal cell diameter, or with Parameters::anisotropic_refinement sqrt(dim) times the smallest extent of all
+  // active cells (over all processes), which accounts for the cells refined anisotropically (and is smaller than the diameter for non-cubic cells,
+  // so the CFL coefficients of the examples with anisotropic refinement are those of cubic cells).
+  double minimal_cell_length() const;
+
+  // The loop of assemble_system() over the locally owned cells, reading prev_solution from its cellwise copy (Number: the storage precision,
+  // chosen once per assembly).
+  template <typename Number>
+  void assemble_cells(const CellwiseSolution<dim, Number>& cellwise, bool assemble_matrix);
+
+  // State at the quadrature point q of fe_v from the values of a cell in the cellwise layout - the primitive components block by block, then the
+  // non-primitive basis functions (the constrained basis functions of a reduced cell are skipped). Summed in double, stored in Number.
+  template <typename Number>
+  void evaluate_state(const CellwiseSolution<dim, Number>& cellwise, const Number* values, const FEValuesBase<dim>& fe_v, const unsigned int q, const bool reduced,
+    std::array<Number, Equations<equationsType, dim>::n_components>& W) const;
+
+  // Performs a local assembly for all volumetric contributions on the local cell (values: its block of cellwise).
+  template <typename Number>
+  void assemble_cell_term(FullMatrix<double>& cell_matrix, Vector<double>& cell_rhs, bool assemble_matrix, const CellwiseSolution<dim, Number>& cellwise, const Number* values);
   
   // Performs a local assembly for all surface contributions on the local cell.
-  // i.e. face terms calculated on all faces - internal and boundary
-  void assemble_face_term(const unsigned int face_no, const FEFaceValuesBase<dim> &fe_v, const FEFaceValuesBase<dim> &fe_v_neighbor, const bool external_face, const unsigned int boundary_id, Vector<double>& cell_rhs);
+  // i.e. face terms calculated on all faces - internal and boundary (values, values_neighbor: the blocks of the cell and the neighbor in cellwise)
+  template <typename Number>
+  void assemble_face_term(const unsigned int face_no, const FEFaceValuesBase<dim> &fe_v, const FEFaceValuesBase<dim> &fe_v_neighbor, const bool external_face, const unsigned int boundary_id, Vector<double>& cell_rhs,
+    const CellwiseSolution<dim, Number>& cellwise, const Number* values, const Number* values_neighbor);
   
   void output_base();
   void output_results(bool use_prev_solution = false) const;
+  // Writes the solution on the planes and lines configured in Parameters - only cells intersecting them are evaluated.
+  void output_slices() const;
+  // Writes one slice - fixed_directions / fixed_positions define the plane (one fixed direction) or line (dim - 1 fixed directions).
+  template <int slice_dim>
+  void output_slice(const std::vector<unsigned int>& fixed_directions, const std::vector<double>& fixed_positions, const std::string& filename_base) const;
   void output_matrix(TrilinosWrappers::SparseMatrix& mat, const char* suffix) const;
   void output_vector(TrilinosWrappers::MPI::Vector& vec, const char* suffix) const;
 
-  // Solves the assembled system
+  // Solves the assembled system into current_limited_solution (unlimited until postprocess()).
   void solve();
 
+  // L2-projection of the initial condition to prev_solution (through current_limited_solution) - the spaces are discontinuous, so it is cell-local,
+  // done by multiple threads, with one InitialCondition::vector_value() call per cell.
+  void project_initial_condition();
+
+  // Refines the initial mesh (by Adaptivity::refine_mesh() of time step 0, until it stops refining) for the projection of the initial condition,
+  // which is left in prev_solution - no time step is assembled or solved on the intermediate meshes.
+  // The indicator is that of the example's Adaptivity, i.e. the jumps of the cell-local projection of the initial condition on the current mesh
+  // (re-projected after each refinement, which samples the initial condition per cell in parallel), not an indicator evaluated from InitialCondition
+  // directly - the projection on the last mesh is the one the first time step starts from.
+  void refine_initial_mesh();
+
+  // Collective - throws if vec has a non-finite (locally owned or ghost) entry on any process, the processes with such entries write the offending cells to a diagnostic file.
+  void check_finite(const TrilinosWrappers::MPI::Vector& vec, const char* stage);
+
   void move_time_step_handle_outputs();
 
   void perform_reset_after_refinement();
   bool reset_after_refinement;
 
+  // Load balancing (Parameters::repartition_imbalance_threshold > 0, MPI only).
+  // Assembly wall-clock time of locally owned cells, per active cell index (smoothed over time steps, reset by setup_system()).
+  std::vector<double> cell_costs;
+  // Connected to the triangulation cell_weight signal - the measured cost relative to the average cell (on top of the weight every cell has).
+  unsigned int cell_weight(const typename Triangulation<dim>::cell_iterator& cell, const typename Triangulation<dim>::CellStatus status) const;
+  // Collective - repartitions (and transfers prev_solution) if the process costs have been imbalanced over the threshold in
+  // Parameters::repartition_imbalanced_checks consecutive calls (called every Parameters::repartition_check_every_nth_time_step steps).
+  void repartition_if_imbalanced();
+  // Average cost of a locally owned cell over all processes, updated by repartition_if_imbalanced().
+  double average_cell_cost;
+  // Consecutive imbalanced checks since the last change of the mesh (reset by perform_reset_after_refinement()).
+  int imbalanced_checks;
+
+  // Local reduction to P0 (Parameters::p0_reduction).
+  // Number of remaining time steps the cell is reduced to piecewise constants, per active cell index (0: full degree, reset by setup_system()).
+  std::vector<int> reduced_degree_steps;
+  // Collective - evaluates the smoothness indicator of prev_solution on the cells of full degree, and rebuilds the constraints (and projects prev_solution) if the reduced cells change.
+  void update_cell_degrees();
+  // The hanging node constraints, plus the non-constant basis functions of the reduced cells constrained to zero.
+  // The DoFs are not removed (the DoFHandler is that of the full degree everywhere), so the reduction only saves assembly work - the constrained
+  // basis functions of a reduced cell (and of a reduced locally owned neighbor) are skipped in assemble_cell_term() and assemble_face_term().
+  void make_degree_constraints();
+  // Whether the currently assembled cell / its neighbor is reduced (set by assemble_cells(); ghost neighbors are never considered reduced, their
+  // degrees are not known here).
+  bool cell_reduced, neighbor_reduced;
+  inline bool is_reduced(const unsigned int active_cell_index) const
+  {
+    return parameters.p0_reduction && (reduced_degree_steps[active_cell_index] > 0);
+  }
+  // Basis function i is constrained to zero on a reduced cell.
+  inline bool skip_basis_fn(const unsigned int i, const bool reduced) const
+  {
+    return reduced && !basis_fn_in_p0[i];
+  }
+
   // Triangulation - passed as a constructor parameter
 #ifdef HAVE_MPI
   parallel::distributed::Triangulation<dim>& triangulation;
@@ -83,16 +159,31 @@ public:
   IndexSet locally_relevant_dofs;
 
   AztecOO* solver;
+  // Legendre basis without the div-free space - the mass matrix is diagonal, and solve() only scales the rhs by its inverse (recomputed with the matrix).
+  const bool diagonal_mass_matrix;
+  TrilinosWrappers::MPI::Vector inverse_mass_diagonal;
   const MappingQ1<dim> mapping;
+  // Parameters::basis for the flow part (and B, unless the div-free space is used).
+  static FESystem<dim> create_fe(const Parameters<dim>& parameters);
   const FESystem<dim> fe;
   DoFHandler<dim> dof_handler;
   const QGauss<dim> quadrature;
   const QGauss<dim - 1> face_quadrature;
 
   // Currently sought solution, the previous one, and the initial solution for newton's loop on the current time level.
+  // The buffers rotate instead of being copied: solve() writes the (locally owned) current_limited_solution, which is imported once to the (ghosted)
+  // current_unlimited_solution and limited in place; without limiting, current_unlimited_solution is swapped into prev_solution at the end of the step.
   TrilinosWrappers::MPI::Vector     current_limited_solution;
   TrilinosWrappers::MPI::Vector     current_unlimited_solution;
   TrilinosWrappers::MPI::Vector     prev_solution;
+  // Whether postprocess() limited the solution in the current time step (then prev_solution is imported from current_limited_solution).
+  bool solution_limited;
+  // Moves the current solution to prev_solution.
+  void advance_solution();
+  // prev_solution per cell (gathered at the start of assemble_system()) - in single precision with Parameters::single_precision_storage (then only
+  // prev_cellwise_float is used). The assembly reads the blocks of the cells directly, in the storage precision.
+  CellwiseSolution<dim> prev_cellwise;
+  CellwiseSolution<dim, float> prev_cellwise_float;
   
   // The system being assembled.
   TrilinosWrappers::MPI::Vector system_rhs;
@@ -102,7 +193,7 @@ public:
   ConstraintMatrix constraints;
   MPI_Comm mpi_communicator;
 
-  double last_output_time, time;
+  double last_output_time, last_slice_output_time, time;
   int time_step_number;
   double cfl_time_step;
   // For CFL.
@@ -119,28 +210,85 @@ public:
   // Slope limiter
   SlopeLimiter<equationsType, dim>* slopeLimiter;
 
+  // Whether some (non-periodic) boundary depends on the gradients - otherwise Wgrad_plus_old is not evaluated, and no face values evaluate gradients.
+  const bool bc_needs_gradients;
+  bool boundary_conditions_need_gradients() const;
+
   const UpdateFlags update_flags;
+  // Interior faces (only values are needed there).
   const UpdateFlags face_update_flags;
+  // Boundary faces - face_update_flags, and gradients if bc_needs_gradients.
+  const UpdateFlags boundary_face_update_flags;
   const UpdateFlags neighbor_face_update_flags;
   // Currently assembled flag.
   typename DoFHandler<dim>::active_cell_iterator cell;
   // DOF indices both on the currently assembled element and the neighbor.
   FEValues<dim> fe_v_cell;
   FEFaceValues<dim> fe_v_face;
+  FEFaceValues<dim> fe_v_face_boundary;
   FESubfaceValues<dim> fe_v_subface;
   FEFaceValues<dim> fe_v_face_neighbor;
   FESubfaceValues<dim> fe_v_subface_neighbor;
   std::vector<types::global_dof_index> dof_indices;
   std::vector<types::global_dof_index> dof_indices_neighbor;
-  std::vector<std::array<double, Equations<equationsType, dim>::n_components> > Wplus_old, Wminus_old;
+  // States and fluxes in the quadrature points of the assembled cell and face, in the precision of the kernels (the storage precision of
+  // prev_solution - the numerical flux and the flux matrix are evaluated in single precision with Parameters::single_precision_storage).
+  template <typename Number>
+  struct QuadratureStates
+  {
+    void resize(const unsigned int n_quadrature_points_cell, const unsigned int n_quadrature_points_face)
+    {
+      W_prev.resize(n_quadrature_points_cell);
+      fluxes_old.resize(n_quadrature_points_cell);
+      Wplus_old.resize(n_quadrature_points_face);
+      Wminus_old.resize(n_quadrature_points_face);
+      normal_fluxes_old.resize(n_quadrature_points_face);
+    }
+    std::vector<std::array<Number, Equations<equationsType, dim>::n_components> > W_prev;
+    std::vector<std::array<std::array<Number, dim>, Equations<equationsType, dim>::n_components> > fluxes_old;
+    std::vector<std::array<Number, Equations<equationsType, dim>::n_components> > Wplus_old, Wminus_old;
+    std::vector<std::array<Number, Equations<equationsType, dim>::n_components> > normal_fluxes_old;
+  };
+  QuadratureStates<double> quadrature_states_double;
+  QuadratureStates<float> quadrature_states_float;
+  inline QuadratureStates<double>& quadrature_states(const double) { return quadrature_states_double; }
+  inline QuadratureStates<float>& quadrature_states(const float) { return quadrature_states_float; }
+  // The states on boundary faces for BoundaryCondition::bc_vector_values() - always in double.
+  std::vector<std::array<double, Equations<equationsType, dim>::n_components> > Wplus_boundary, Wminus_boundary;
   std::vector<std::array<std::array<double, dim>, Equations<equationsType, dim>::n_components> > Wgrad_plus_old;
-  std::vector<std::array<double, Equations<equationsType, dim>::n_components> > normal_fluxes_old;
-  std::vector<std::array<double, Equations<equationsType, dim>::n_components> > W_prev;
-  std::vector<std::array<std::array<double, dim>, Equations<equationsType, dim>::n_components> > fluxes_old;
+  // Boundary values of faces whose boundary conditions depend on neither time, state nor gradients, per (active cell index * faces per cell + face number).
+  // Cleared in perform_reset_after_refinement().
+  std::map<unsigned int, std::vector<std::array<double, Equations<equationsType, dim>::n_components> > > boundary_state_cache;
 
-  std::array <unsigned short, BASIS_FN_COUNT> component_ii;
-  std::array <bool, BASIS_FN_COUNT> is_primitive;
-  std::array <bool, BASIS_FN_COUNT> basis_fn_is_constant;
+  std::vector<unsigned short> component_ii;
+  // Flags per basis function - unsigned char, not the bit-packed std::vector<bool>, as they are read in the innermost assembly loops.
+  std::vector<unsigned char> is_primitive;
+  std::vector<unsigned char> basis_fn_is_constant;
+  // Constant basis functions (including the non-primitive ones) - those kept in reduced cells of the P0 reduction.
+  std::vector<unsigned char> basis_fn_in_p0;
+
+  struct ProjectionScratchData
+  {
+    ProjectionScratchData(const Mapping<dim>& mapping, const FiniteElement<dim>& fe, const Quadrature<dim>& quadrature);
+    ProjectionScratchData(const ProjectionScratchData& scratch);
+    FEValues<dim> fe_v;
+    std::vector<std::array<double, Equations<equationsType, dim>::n_components> > W;
+    FullMatrix<double> mass_matrix;
+    Vector<double> rhs;
+  };
+  struct ProjectionCopyData
+  {
+    std::vector<types::global_dof_index> dof_indices;
+    Vector<double> coefficients;
+  };
+  void projection_worker(const typename DoFHandler<dim>::active_cell_iterator& cell, ProjectionScratchData& scratch, ProjectionCopyData& copy_data) const;
+  void projection_copier(const ProjectionCopyData& copy_data);
 
   Adaptivity<dim>* adaptivity;
+  // Jumps of Parameters::assembly_indicator_components over interior faces, and the faces' area, per active cell index and direction (face number / 2).
+  // Accumulated by assemble_face_term() for the adaptivity indicator.
+  std::vector<std::array<double, dim> > assembly_jumps, assembly_areas;
+
+  // Stage timers.
+  Timing<dim> timing;
 };
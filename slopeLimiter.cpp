@@ -1,15 +1,60 @@
 #include "slopeLimiter.h"
 #include "problem.h"
 
+template <EquationsType equationsType, int dim>
+void SlopeLimiter<equationsType, dim>::gather_unlimited(const TrilinosWrappers::MPI::Vector& current_unlimited_solution)
+{
+  if (!this->cellwise_initialized)
+  {
+    this->unlimited_cellwise.reinit(this->dof_handler);
+    // Here we rely on the fact, that the constant basis fn is the first one of its component.
+    bool mean_set[Equations<equationsType, dim>::n_components];
+    for (int k = 0; k < Equations<equationsType, dim>::n_components; k++)
+      mean_set[k] = false;
+    this->mean_positions.clear();
+    for (unsigned int i = 0; i < this->dofs_per_cell; ++i)
+    {
+      if (this->is_primitive[i] && !mean_set[this->component_ii[i]])
+      {
+        this->mean_positions.push_back(std::make_pair(this->component_ii[i], this->unlimited_cellwise.position(i)));
+        mean_set[this->component_ii[i]] = true;
+      }
+    }
+    this->cellwise_initialized = true;
+  }
+  this->unlimited_cellwise.gather(current_unlimited_solution);
+}
+
+template <EquationsType equationsType, int dim>
+void SlopeLimiter<equationsType, dim>::point_value(const typename DoFHandler<dim>::active_cell_iterator& cell, const Point<dim>& point, Vector<double>& value) const
+{
+  const Point<dim> p_cell = this->mapping.transform_real_to_unit_cell(cell, point);
+  const Quadrature<dim> one_point_quadrature(GeometryInfo<dim>::project_to_unit_cell(p_cell));
+  FEValues<dim> fe_values(this->mapping, this->fe, one_point_quadrature, update_values);
+  fe_values.reinit(cell);
+  const double* values = this->unlimited_cellwise.cell_values(cell->active_cell_index());
+  // The primitive components block by block, then the non-primitive basis functions.
+  value = 0.;
+  const unsigned int n_components = this->fe.n_components();
+  for (unsigned int c = 0; c < n_components; ++c)
+    for (unsigned int p = this->unlimited_cellwise.block_start(c); p < this->unlimited_cellwise.block_start(c + 1); ++p)
+      value[c] += values[p] * fe_values.shape_value(this->unlimited_cellwise.dof(p), 0);
+  for (unsigned int p = this->unlimited_cellwise.block_start(n_components); p < this->dofs_per_cell; ++p)
+    for (unsigned int c = 0; c < n_components; ++c)
+      value[c] += values[p] * fe_values.shape_value_component(this->unlimited_cellwise.dof(p), 0, c);
+}
+
 template <EquationsType equationsType, int dim>
 void VertexBasedSlopeLimiter<equationsType, dim>::flush_cache()
 {
   this->postprocessData.clear();
+  this->cellwise_initialized = false;
 }
 
 template <EquationsType equationsType, int dim>
 void VertexBasedSlopeLimiter<equationsType, dim>::postprocess(TrilinosWrappers::MPI::Vector& current_limited_solution, TrilinosWrappers::MPI::Vector& current_unlimited_solution)
 {
+  this->gather_unlimited(current_unlimited_solution);
   int cell_count = 0;
   // Loop through all cells.
   for (typename DoFHandler<dim>::active_cell_iterator cell = this->dof_handler.begin_active(); cell != this->dof_handler.end(); ++cell)
@@ -70,32 +115,20 @@ void VertexBasedSlopeLimiter<equationsType, dim>::postprocess(TrilinosWrappers::
           typename DoFHandler<dim>::active_cell_iterator neighbor(&this->triangulation, neighbor_element->level(), neighbor_element->index(), &this->dof_handler);
           if (neighbor->active_cell_index() != cell->active_cell_index())
           {
-            data->neighbor_dof_indices[vertex_i][neighbor_i].resize(this->dofs_per_cell);
-            neighbor->get_dof_indices(data->neighbor_dof_indices[vertex_i][neighbor_i++]);
+            data->neighbor_cell_indices[vertex_i].push_back(neighbor->active_cell_index());
+            neighbor_i++;
           }
         }
         data->neighbor_count = neighbor_i;
       }
     }
 
-    // Cell center value we must find in any case (new data or reused)
-    // - let us reuse this array for that.
-    for (int i = 0; i < Equations<equationsType, dim>::n_components; i++)
-      u_c_set[i] = false;
-    for (unsigned int i = 0; i < this->dofs_per_cell; ++i)
-    {
-      if (this->is_primitive[i])
-      {
-        // Here we rely on the fact, that the constant basis fn is the first one and that all other basis fns have zero mean.
-        if (!u_c_set[this->component_ii[i]])
-        {
-          u_c[this->component_ii[i]] = current_unlimited_solution(this->dof_indices[i]);
-          u_c_set[this->component_ii[i]] = true;
-        }
-      }
-    }
+    // Cell center value we must find in any case (new data or reused) - all basis fns but the constant one have zero mean.
+    const double* values = this->unlimited_cellwise.cell_values(cell->active_cell_index());
+    for (unsigned int m = 0; m < this->mean_positions.size(); ++m)
+      u_c[this->mean_positions[m].first] = values[this->mean_positions[m].second];
 
-    if (this->parameters.debug & this->parameters.SlopeLimiting)
+    if (DEBUG_FLAG_SET(this->parameters, SlopeLimiting))
       LOGL(2, "cell: " << ++cell_count << " - center: " << data->center << ", values: " << u_c[0] << ", " << u_c[1] << ", " << u_c[2] << ", " << u_c[3] << ", " << u_c[4]);
 
     double alpha_e[Equations<equationsType, dim>::n_components];
@@ -109,15 +142,9 @@ void VertexBasedSlopeLimiter<equationsType, dim>::postprocess(TrilinosWrappers::
 
       // (!!!) Find out u_i
       Vector<double> u_i(Equations<equationsType, dim>::n_components);
-      const Point<dim> p_cell = this->mapping.transform_real_to_unit_cell(cell, data->vertexPoint[vertex_i]);
-      const Quadrature<dim> one_point_quadrature(GeometryInfo<dim>::project_to_unit_cell(p_cell));
-      FEValues<dim> fe_values(this->mapping, this->fe, one_point_quadrature, update_values);
-      fe_values.reinit(cell);
-      std::vector<Vector<double> > u_value(1, Vector<double>(this->fe.n_components()));
-      fe_values.get_function_values(current_unlimited_solution, u_value);
-      u_i = u_value[0];
-
-      if (this->parameters.debug & this->parameters.SlopeLimiting)
+      this->point_value(cell, data->vertexPoint[vertex_i], u_i);
+
+      if (DEBUG_FLAG_SET(this->parameters, SlopeLimiting))
       {
         LOGL(3, "\tv_i: " << cell->vertex(vertex_i) << ", values: ");
         for (int i = 0; i < Equations<equationsType, dim>::n_components; i++)
@@ -134,34 +161,22 @@ void VertexBasedSlopeLimiter<equationsType, dim>::postprocess(TrilinosWrappers::
       }
 
       // For all vertices -> v_i
-      for (auto dof_indices_neighbor : data->neighbor_dof_indices[vertex_i])
+      for (unsigned int n = 0; n < data->neighbor_cell_indices[vertex_i].size(); ++n)
       {
-        if (dof_indices_neighbor.size() == 0)
-          continue;
-        bool u_i_extrema_set[Equations<equationsType, dim>::n_components];
-        for (int i = 0; i < Equations<equationsType, dim>::n_components; i++)
-          u_i_extrema_set[i] = false;
-
-        for (unsigned int i = 0; i < this->dofs_per_cell; ++i)
+        const double* neighbor_values = this->unlimited_cellwise.cell_values(data->neighbor_cell_indices[vertex_i][n]);
+        for (unsigned int m = 0; m < this->mean_positions.size(); ++m)
         {
-          if (this->is_primitive[i])
+          const unsigned short k = this->mean_positions[m].first;
+          const double val = neighbor_values[this->mean_positions[m].second];
+          if (DEBUG_FLAG_SET(this->parameters, SlopeLimiting))
           {
-            // Here we rely on the fact, that the constant basis fn is the first one.
-            if (!u_i_extrema_set[this->component_ii[i]])
-            {
-              double val = current_unlimited_solution(dof_indices_neighbor[i]);
-              if (this->parameters.debug & this->parameters.SlopeLimiting)
-              {
-                if (val < u_i_min[this->component_ii[i]])
-                  LOGL(3, "\tdecreasing u_i_min to: " << val);
-                if (val > u_i_max[this->component_ii[i]])
-                  LOGL(3, "\tincreasing u_i_max to: " << val);
-              }
-              u_i_min[this->component_ii[i]] = std::min(u_i_min[this->component_ii[i]], val);
-              u_i_max[this->component_ii[i]] = std::max(u_i_max[this->component_ii[i]], val);
-              u_i_extrema_set[this->component_ii[i]] = true;
-            }
+            if (val < u_i_min[k])
+              LOGL(3, "\tdecreasing u_i_min to: " << val);
+            if (val > u_i_max[k])
+              LOGL(3, "\tincreasing u_i_max to: " << val);
           }
+          u_i_min[k] = std::min(u_i_min[k], val);
+          u_i_max[k] = std::max(u_i_max[k], val);
         }
       }
 
@@ -173,7 +188,7 @@ void VertexBasedSlopeLimiter<equationsType, dim>::postprocess(TrilinosWrappers::
         if (std::abs((u_c[k] - u_i[k]) / u_c[k]) > NEGLIGIBLE)
         {
           alpha_e[k] = std::min(alpha_e[k], ((u_i[k] - u_c[k]) > 0.) ? std::min(1.0, (u_i_max[k] - u_c[k]) / (u_i[k] - u_c[k])) : std::min(1.0, (u_i_min[k] - u_c[k]) / (u_i[k] - u_c[k])));
-          if (this->parameters.debug & this->parameters.SlopeLimiting)
+          if (DEBUG_FLAG_SET(this->parameters, SlopeLimiting))
             LOGL(1, "\talpha_e[" << k << "]: " << alpha_e[k]);
         }
       }
@@ -200,11 +215,13 @@ template <EquationsType equationsType, int dim>
 void BarthJespersenSlopeLimiter<equationsType, dim>::flush_cache()
 {
   this->postprocessData.clear();
+  this->cellwise_initialized = false;
 }
 
 template <EquationsType equationsType, int dim>
 void BarthJespersenSlopeLimiter<equationsType, dim>::postprocess(TrilinosWrappers::MPI::Vector& current_limited_solution, TrilinosWrappers::MPI::Vector& current_unlimited_solution)
 {
+  this->gather_unlimited(current_unlimited_solution);
   int cell_count = 0;
   // Loop through all cells.
   for (typename DoFHandler<dim>::active_cell_iterator cell = this->dof_handler.begin_active(); cell != this->dof_handler.end(); ++cell)
@@ -255,31 +272,19 @@ void BarthJespersenSlopeLimiter<equationsType, dim>::postprocess(TrilinosWrapper
           typename DoFHandler<dim>::active_cell_iterator neighbor(&this->triangulation, neighbor_element->level(), neighbor_element->index(), &this->dof_handler);
           if (neighbor->active_cell_index() != cell->active_cell_index())
           {
-            data->neighbor_dof_indices[vertex_i][neighbor_i].resize(this->dofs_per_cell);
-            neighbor->get_dof_indices(data->neighbor_dof_indices[vertex_i][neighbor_i++]);
+            data->neighbor_cell_indices[vertex_i].push_back(neighbor->active_cell_index());
+            neighbor_i++;
           }
         }
       }
     }
 
-    // Cell center value we must find in any case (new data or reused)
-    // - let us reuse this array for that.
-    for (int i = 0; i < Equations<equationsType, dim>::n_components; i++)
-      u_c_set[i] = false;
-    for (unsigned int i = 0; i < this->dofs_per_cell; ++i)
-    {
-      if (this->is_primitive[i])
-      {
-        // Here we rely on the fact, that the constant basis fn is the first one and that all other basis fns have zero mean.
-        if (!u_c_set[this->component_ii[i]])
-        {
-          u_c[this->component_ii[i]] = current_unlimited_solution(this->dof_indices[i]);
-          u_c_set[this->component_ii[i]] = true;
-        }
-      }
-    }
+    // Cell center value we must find in any case (new data or reused) - all basis fns but the constant one have zero mean.
+    const double* values = this->unlimited_cellwise.cell_values(cell->active_cell_index());
+    for (unsigned int m = 0; m < this->mean_positions.size(); ++m)
+      u_c[this->mean_positions[m].first] = values[this->mean_positions[m].second];
 
-    if (this->parameters.debug & this->parameters.SlopeLimiting)
+    if (DEBUG_FLAG_SET(this->parameters, SlopeLimiting))
       LOGL(2, "cell: " << ++cell_count << " - center: " << data->center << ", values: " << u_c[0] << ", " << u_c[1] << ", " << u_c[2] << ", " << u_c[3] << ", " << u_c[4]);
 
     double alpha_e[Equations<equationsType, dim>::n_components];
@@ -297,34 +302,22 @@ void BarthJespersenSlopeLimiter<equationsType, dim>::postprocess(TrilinosWrapper
     for (unsigned int vertex_i = 0; vertex_i < GeometryInfo<dim>::vertices_per_cell; ++vertex_i)
     {
       // For all vertices -> v_i
-      for (auto dof_indices_neighbor : data->neighbor_dof_indices[vertex_i])
+      for (unsigned int n = 0; n < data->neighbor_cell_indices[vertex_i].size(); ++n)
       {
-        if (dof_indices_neighbor.size() == 0)
-          continue;
-        bool u_i_extrema_set[Equations<equationsType, dim>::n_components];
-        for (int i = 0; i < Equations<equationsType, dim>::n_components; i++)
-          u_i_extrema_set[i] = false;
-
-        for (unsigned int i = 0; i < this->dofs_per_cell; ++i)
+        const double* neighbor_values = this->unlimited_cellwise.cell_values(data->neighbor_cell_indices[vertex_i][n]);
+        for (unsigned int m = 0; m < this->mean_positions.size(); ++m)
         {
-          if (this->is_primitive[i])
+          const unsigned short k = this->mean_positions[m].first;
+          const double val = neighbor_values[this->mean_positions[m].second];
+          if (DEBUG_FLAG_SET(this->parameters, SlopeLimiting))
           {
-            // Here we rely on the fact, that the constant basis fn is the first one.
-            if (!u_i_extrema_set[this->component_ii[i]])
-            {
-              double val = current_unlimited_solution(dof_indices_neighbor[i]);
-              if (this->parameters.debug & this->parameters.SlopeLimiting)
-              {
-                if (val < u_i_min[this->component_ii[i]])
-                  LOGL(3, "\tdecreasing u_i_min to: " << val);
-                if (val > u_i_max[this->component_ii[i]])
-                  LOGL(3, "\tincreasing u_i_max to: " << val);
-              }
-              u_i_min[this->component_ii[i]] = std::min(u_i_min[this->component_ii[i]], val);
-              u_i_max[this->component_ii[i]] = std::max(u_i_max[this->component_ii[i]], val);
-              u_i_extrema_set[this->component_ii[i]] = true;
-            }
+            if (val < u_i_min[k])
+              LOGL(3, "\tdecreasing u_i_min to: " << val);
+            if (val > u_i_max[k])
+              LOGL(3, "\tincreasing u_i_max to: " << val);
           }
+          u_i_min[k] = std::min(u_i_min[k], val);
+          u_i_max[k] = std::max(u_i_max[k], val);
         }
       }
     }
@@ -334,15 +327,9 @@ void BarthJespersenSlopeLimiter<equationsType, dim>::postprocess(TrilinosWrapper
     {
       // (!!!) Find out u_i
       Vector<double> u_i(Equations<equationsType, dim>::n_components);
-      const Point<dim> p_cell = this->mapping.transform_real_to_unit_cell(cell, data->vertexPoint[vertex_i]);
-      const Quadrature<dim> one_point_quadrature(GeometryInfo<dim>::project_to_unit_cell(p_cell));
-      FEValues<dim> fe_values(this->mapping, this->fe, one_point_quadrature, update_values);
-      fe_values.reinit(cell);
-      std::vector<Vector<double> > u_value(1, Vector<double>(this->fe.n_components()));
-      fe_values.get_function_values(current_unlimited_solution, u_value);
-      u_i = u_value[0];
-
-      if (this->parameters.debug & this->parameters.SlopeLimiting)
+      this->point_value(cell, data->vertexPoint[vertex_i], u_i);
+
+      if (DEBUG_FLAG_SET(this->parameters, SlopeLimiting))
       {
         LOGL(3, "\tv_i: " << cell->vertex(vertex_i) << ", values: ");
         for (int i = 0; i < Equations<equationsType, dim>::n_components; i++)
@@ -353,7 +340,7 @@ void BarthJespersenSlopeLimiter<equationsType, dim>::postprocess(TrilinosWrapper
         if (std::abs((u_c[k] - u_i[k]) / u_c[k]) > NEGLIGIBLE)
         {
           alpha_e[k] = std::min(alpha_e[k], ((u_i[k] - u_c[k]) > 0.) ? std::min(1.0, (u_i_max[k] - u_c[k]) / (u_i[k] - u_c[k])) : std::min(1.0, (u_i_min[k] - u_c[k]) / (u_i[k] - u_c[k])));
-          if (this->parameters.debug & this->parameters.SlopeLimiting)
+          if (DEBUG_FLAG_SET(this->parameters, SlopeLimiting))
             LOGL(5, "\talpha_e[" << k << "]: " << alpha_e[k]);
         }
     }
@@ -3,6 +3,7 @@
 
 #include "equationsMhd.h"
 #include "parameters.h"
+#include "cellwiseSolution.h"
 
 template <EquationsType equationsType, int dim>
 class SlopeLimiter
@@ -15,7 +16,7 @@ public:
 #else
     Triangulation<dim>& triangulation,
 #endif
-    std::vector<types::global_dof_index>& dof_indices, std::array <unsigned short, BASIS_FN_COUNT>& component_ii, std::array <bool, BASIS_FN_COUNT>& is_primitive) : 
+    std::vector<types::global_dof_index>& dof_indices, std::vector<unsigned short>& component_ii, std::vector<unsigned char>& is_primitive) : 
     parameters(parameters),
     mapping(mapping),
     fe(fe),
@@ -24,10 +25,13 @@ public:
     triangulation(triangulation),
     dof_indices(dof_indices),
     component_ii(component_ii),
-    is_primitive(is_primitive)
+    is_primitive(is_primitive),
+    cellwise_initialized(false)
     {};
 
   // Not const because of caching.
+  // Limits current_limited_solution in place - only the non-constant coefficients of each cell are scaled, the values (cell means of the neighbors, and
+  // the cell's own values) are read from current_unlimited_solution, its ghosted copy (gathered once into the cellwise layout).
   virtual void postprocess(TrilinosWrappers::MPI::Vector& current_limited_solution, TrilinosWrappers::MPI::Vector& current_unlimited_solution) = 0;
   virtual void flush_cache() = 0;
 protected:
@@ -39,8 +43,8 @@ protected:
     Point<dim> vertexPoint[GeometryInfo<dim>::vertices_per_cell];
     std::vector<unsigned int> lambda_indices_to_multiply[Equations<equationsType, dim>::n_components];
     std::vector<unsigned int> lambda_indices_to_multiply_all_B_components;
-    // TODO This may not work for adaptivity (max. number of cells sharing a vertes might be higher than 8)
-    std::vector<types::global_dof_index> neighbor_dof_indices[GeometryInfo<dim>::vertices_per_cell][GeometryInfo<dim>::vertices_per_cell];
+    // Active cell indices of the other cells sharing the vertex.
+    std::vector<unsigned int> neighbor_cell_indices[GeometryInfo<dim>::vertices_per_cell];
     unsigned short neighbor_count;
     std::array<bool, GeometryInfo<dim>::vertices_per_cell> vertex_is_at_nonperiodic_boundary;
   };
@@ -58,8 +62,18 @@ protected:
   DoFHandler<dim>& dof_handler;
   unsigned int& dofs_per_cell;
   std::vector<types::global_dof_index>& dof_indices;
-  std::array <unsigned short, BASIS_FN_COUNT>& component_ii;
-  std::array <bool, BASIS_FN_COUNT>& is_primitive;
+  std::vector<unsigned short>& component_ii;
+  std::vector<unsigned char>& is_primitive;
+
+  // Copy of current_unlimited_solution in the cellwise layout, and the positions (in it) of the constant basis function of each primitive component
+  // (the cell mean).
+  CellwiseSolution<dim> unlimited_cellwise;
+  std::vector<std::pair<unsigned short, unsigned int> > mean_positions;
+  // The layout is set up again in the first gather after flush_cache().
+  bool cellwise_initialized;
+  void gather_unlimited(const TrilinosWrappers::MPI::Vector& current_unlimited_solution);
+  // Value of the (unlimited) solution of the cell at the point.
+  void point_value(const typename DoFHandler<dim>::active_cell_iterator& cell, const Point<dim>& point, Vector<double>& value) const;
 };
 
 template <EquationsType equationsType, int dim>
@@ -73,7 +87,7 @@ public:
 #else
     Triangulation<dim>& triangulation,
 #endif
-    std::vector<types::global_dof_index>& dof_indices, std::array <unsigned short, BASIS_FN_COUNT>& component_ii, std::array <bool, BASIS_FN_COUNT>& is_primitive) : 
+    std::vector<types::global_dof_index>& dof_indices, std::vector<unsigned short>& component_ii, std::vector<unsigned char>& is_primitive) : 
     SlopeLimiter<equationsType, dim>(parameters, mapping, fe, dof_handler, dofs_per_cell, triangulation, dof_indices, component_ii, is_primitive) {};
   // Not const because of caching.
   virtual void postprocess(TrilinosWrappers::MPI::Vector& current_limited_solution, TrilinosWrappers::MPI::Vector& current_unlimited_solution);
@@ -91,7 +105,7 @@ public:
 #else
     Triangulation<dim>& triangulation,
 #endif
-    std::vector<types::global_dof_index>& dof_indices, std::array <unsigned short, BASIS_FN_COUNT>& component_ii, std::array <bool, BASIS_FN_COUNT>& is_primitive) : 
+    std::vector<types::global_dof_index>& dof_indices, std::vector<unsigned short>& component_ii, std::vector<unsigned char>& is_primitive) : 
     SlopeLimiter<equationsType, dim>(parameters, mapping, fe, dof_handler, dofs_per_cell, triangulation, dof_indices, component_ii, is_primitive) {};
   // Not const because of caching.
   virtual void postprocess(TrilinosWrappers::MPI::Vector& current_limited_solution, TrilinosWrappers::MPI::Vector& current_unlimited_solution);
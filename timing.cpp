@@ -0,0 +1,89 @@
+#include "timing.h"
+
+// Stage names, as they appear in the summary and in the machine-readable file.
+static const char* timing_stage_names[timing_stage_count] = { "assemble", "cells", "faces", "numerical flux", "solve", "limiter", "cfl", "refinement", "solution transfer", "output", "initial condition" };
+
+// Stage in which the stage is nested (-1 for top-level stages).
+static const int timing_stage_parents[timing_stage_count] = { -1, timing_assemble, timing_assemble, timing_assemble_faces, -1, -1, -1, -1, timing_refinement, -1, -1 };
+
+template <int dim>
+Timing<dim>::Timing(const Parameters<dim>& parameters, MPI_Comm& mpi_communicator) :
+  enabled(parameters.timing), parameters(parameters), mpi_communicator(mpi_communicator)
+{
+  elapsed.fill(0.);
+  calls.fill(0);
+}
+
+template <int dim>
+void Timing<dim>::gather(std::array<Utilities::MPI::MinMaxAvg, timing_stage_count>& statistics) const
+{
+  for (unsigned int stage = 0; stage < timing_stage_count; ++stage)
+    statistics[stage] = Utilities::MPI::min_max_avg(this->elapsed[stage], this->mpi_communicator);
+}
+
+template <int dim>
+void Timing<dim>::end_time_step(int time_step_number)
+{
+  if (!this->enabled || (parameters.timing_output_every_nth_step <= 0) || (time_step_number % parameters.timing_output_every_nth_step) != 0)
+    return;
+
+  std::array<Utilities::MPI::MinMaxAvg, timing_stage_count> statistics;
+  gather(statistics);
+  write_file(time_step_number, statistics);
+}
+
+template <int dim>
+void Timing<dim>::finish(int time_step_number)
+{
+  if (!this->enabled)
+    return;
+
+  std::array<Utilities::MPI::MinMaxAvg, timing_stage_count> statistics;
+  gather(statistics);
+  write_file(time_step_number, statistics);
+
+  if (Utilities::MPI::this_mpi_process(mpi_communicator) != 0)
+    return;
+
+  std::cout << std::endl << "Timing [s]" << std::setw(33) << "min" << std::setw(12) << "avg" << std::setw(12) << "max" << std::setw(12) << "calls" << std::endl;
+  for (unsigned int stage = 0; stage < timing_stage_count; ++stage)
+  {
+    int depth = 0;
+    for (int parent = timing_stage_parents[stage]; parent >= 0; parent = timing_stage_parents[parent])
+      depth++;
+    const std::string name = std::string(2 * depth, ' ') + timing_stage_names[stage];
+    std::cout << std::left << std::setw(31) << name << std::right << std::fixed << std::setprecision(3)
+      << std::setw(12) << statistics[stage].min << std::setw(12) << statistics[stage].avg << std::setw(12) << statistics[stage].max
+      << std::setw(12) << this->calls[stage] << std::endl;
+  }
+  std::cout.unsetf(std::ios_base::floatfield);
+}
+
+template <int dim>
+double Timing<dim>::time_step_seconds() const
+{
+  double seconds = 0.;
+  for (unsigned int stage = 0; stage < timing_stage_count; ++stage)
+    if ((timing_stage_parents[stage] < 0) && (stage != timing_output) && (stage != timing_initial_condition))
+      seconds += this->elapsed[stage];
+  return seconds;
+}
+
+template <int dim>
+void Timing<dim>::write_file(int time_step_number, const std::array<Utilities::MPI::MinMaxAvg, timing_stage_count>& statistics)
+{
+  if (Utilities::MPI::this_mpi_process(mpi_communicator) != 0)
+    return;
+
+  if (!this->file.is_open())
+  {
+    this->file.open((parameters.output_file_prefix + "timing.csv").c_str());
+    this->file << "step,stage,parent,calls,min,avg,max" << std::endl;
+  }
+
+  for (unsigned int stage = 0; stage < timing_stage_count; ++stage)
+    this->file << time_step_number << "," << timing_stage_names[stage] << "," << (timing_stage_parents[stage] >= 0 ? timing_stage_names[timing_stage_parents[stage]] : "")
+    << "," << this->calls[stage] << "," << statistics[stage].min << "," << statistics[stage].avg << "," << statistics[stage].max << std::endl;
+}
+
+template class Timing<3>;
@@ -0,0 +1,84 @@
+#ifndef _TIMING_H
+#define _TIMING_H
+
+#include "util.h"
+#include "parameters.h"
+
+// Timed stages of Problem::run(), stage_parents in timing.cpp defines which stage is nested in which.
+enum TimingStage
+{
+  timing_assemble,
+  timing_assemble_cells,
+  timing_assemble_faces,
+  timing_numerical_flux,
+  timing_solve,
+  timing_limiter,
+  timing_cfl,
+  timing_refinement,
+  timing_solution_transfer,
+  timing_output,
+  timing_initial_condition,
+  timing_stage_count
+};
+
+// Hierarchical wall-clock timers of the stages of Problem::run().
+// When disabled (Parameters::timing), start() / stop() only test a flag, so the calls may stay in the hot loops.
+template <int dim>
+class Timing
+{
+public:
+  Timing(const Parameters<dim>& parameters, MPI_Comm& mpi_communicator);
+
+  inline void start(TimingStage stage)
+  {
+    if (this->enabled)
+      this->started[stage] = std::chrono::steady_clock::now();
+  }
+
+  inline void stop(TimingStage stage)
+  {
+    if (this->enabled)
+    {
+      this->elapsed[stage] += std::chrono::duration<double>(std::chrono::steady_clock::now() - this->started[stage]).count();
+      this->calls[stage]++;
+    }
+  }
+
+  // Called by all processes after every time step, writes the machine-readable file every Parameters::timing_output_every_nth_step steps.
+  void end_time_step(int time_step_number);
+
+  // Called by all processes at the end of the computation, prints min / max / avg over processes and writes the machine-readable file.
+  void finish(int time_step_number);
+
+  // Seconds (on this process) spent in the time steps - the top-level stages except the output and the initial condition.
+  double time_step_seconds() const;
+
+  const bool enabled;
+
+private:
+  // Collective - per stage min / max / avg of the elapsed time over all processes.
+  void gather(std::array<Utilities::MPI::MinMaxAvg, timing_stage_count>& statistics) const;
+  void write_file(int time_step_number, const std::array<Utilities::MPI::MinMaxAvg, timing_stage_count>& statistics);
+
+  std::array<std::chrono::steady_clock::time_point, timing_stage_count> started;
+  std::array<double, timing_stage_count> elapsed;
+  std::array<unsigned long, timing_stage_count> calls;
+
+  const Parameters<dim>& parameters;
+  MPI_Comm& mpi_communicator;
+  std::ofstream file;
+};
+
+// Times the enclosing scope.
+template <int dim>
+class TimingScope
+{
+public:
+  TimingScope(Timing<dim>& timing, TimingStage stage) : timing(timing), stage(stage) { timing.start(stage); }
+  ~TimingScope() { timing.stop(stage); }
+private:
+  Timing<dim>& timing;
+  const TimingStage stage;
+};
+
+#endif
@@ -9,9 +9,15 @@
 #include <stdio.h>
 #include <memory>
 #include <chrono>
+#include <functional>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <tuple>
+#include <map>
+#include <algorithm>
+#include <iomanip>
+#include <array>
 #include <deal.II/base/quadrature_lib.h>
 #include <deal.II/base/numbers.h>
 #include <deal.II/base/function.h>
@@ -19,6 +25,7 @@
 #include <deal.II/base/function_parser.h>
 #include <deal.II/base/utilities.h>
 #include <deal.II/base/conditional_ostream.h>
+#include <deal.II/base/work_stream.h>
 #include <deal.II/fe/fe_tools.h>
 #include <deal.II/base/std_cxx11/array.h>
 
@@ -33,6 +40,7 @@
 #include <deal.II/grid/grid_generator.h>
 #include <deal.II/grid/tria_accessor.h>
 #include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/filtered_iterator.h>
 #include <deal.II/grid/grid_in.h>
 
 #include <deal.II/dofs/dof_handler.h>
@@ -80,74 +88,154 @@ std::string to_string_with_precision(const T a_value, const int n = 6)
   return out.str();
 }
 
-template <int Offset = 0>
-class Log
+// Extents of the cell in the coordinate directions (the Taylor-type bases are scaled by them, so that anisotropic cells are handled).
+template <int dim, typename CellIterator>
+inline Point<dim> cell_extents(const CellIterator& cell)
 {
-public:
-  template <typename T>
-  const Log& operator << (const T &t) const
+  Point<dim> h;
+  for (unsigned int d = 0; d < dim; ++d)
+    h[d] = cell->extent_in_direction(d);
+  return h;
+}
+
+// Extent of the cell in the coordinate direction closest to the (face) normal.
+template <int dim, typename CellIterator>
+inline double cell_extent_along(const CellIterator& cell, const Tensor<1, dim>& normal)
+{
+  unsigned int axis = 0;
+  for (unsigned int d = 1; d < dim; ++d)
+    if (std::abs(normal[d]) > std::abs(normal[axis]))
+      axis = d;
+  return cell->extent_in_direction(axis);
+}
+
+// Box [corner_a, corner_b] with refinements[d] cells in the direction d, the boundary ids 2d (lower) and 2d + 1 (upper) and the periodic boundaries
+// (triplets of the two boundary ids and the direction) - the same mesh as GridGenerator::subdivided_hyper_rectangle() + periodicity, but built from
+// the coarse mesh of refinements[d] / 2^k cells (2^k the largest power of two dividing all refinements[d]) refined globally k times.
+// parallel::distributed::Triangulation stores the whole coarse mesh (as p4est trees) on every process, so e.g. 256^3 cells are just one tree,
+// 50 x 100 x 50 cells are 25 x 50 x 25 trees. Returns k.
+template <int dim, typename TriangulationType>
+unsigned int create_box(TriangulationType& triangulation, std::vector<unsigned int> refinements, const Point<dim>& corner_a, const Point<dim>& corner_b,
+  const std::vector<std::array<int, 3> >& periodic_boundaries)
+{
+  unsigned int global_refinements = 0;
+  while (true)
   {
-    for (int i = Offset; i > 0; i--)
-      std::cout << " | ";
-#ifdef HAVE_MPI
-    if(Offset == 0)
-      std::cout << "proc. #" << Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) << " | ";
-#endif
-    std::cout << t;
-    return *this;
+    bool all_even = true;
+    for (unsigned int d = 0; d < dim; ++d)
+      all_even = all_even && (refinements[d] % 2 == 0);
+    if (!all_even)
+      break;
+    for (unsigned int d = 0; d < dim; ++d)
+      refinements[d] /= 2;
+    ++global_refinements;
   }
 
-  const Log& operator << (std::ostream& (*p) (std::ostream &)) const
+  GridGenerator::subdivided_hyper_rectangle(triangulation, refinements, corner_a, corner_b, true);
+
+  // The periodicity has to be set on the coarse mesh.
+  if (periodic_boundaries.size() > 0)
   {
-    for (int i = Offset; i > 0; i--)
-      std::cout << " | ";
-#ifdef HAVE_MPI
-    if (Offset == 0)
-      std::cout << "proc. #" << Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) << " | ";
-#endif
-    std::cout << p;
-    return *this;
+    std::vector<dealii::GridTools::PeriodicFacePair< dealii::TriaIterator<dealii::CellAccessor<dim> > > > matched_pairs;
+    for (std::vector<std::array<int, 3> >::const_iterator it = periodic_boundaries.begin(); it != periodic_boundaries.end(); it++)
+      dealii::GridTools::collect_periodic_faces(triangulation, (*it)[0], (*it)[1], (*it)[2], matched_pairs);
+    triangulation.add_periodicity(matched_pairs);
   }
-};
 
-template <int Offset = 0>
-class Logline
+  triangulation.refine_global(global_refinements);
+  return global_refinements;
+}
+
+// Per-process log sink - messages are formatted directly into a buffer, which is written out when full or on flush().
+class LogSink
 {
 public:
-  template <typename T>
-  const Logline& operator << (const T &t) const
+  // Which processes write log messages.
+  enum Mode { all_processes, first_process_only, quiet };
+
+  static LogSink& instance()
   {
-    for (int i = Offset; i > 0; i--)
-      std::cout << "  ";
-#ifdef HAVE_MPI
-    std::cout << "proc. #" << Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) << " | ";
-#endif
-    std::cout << t;
-    std::cout << std::endl;
-    return *this;
+    static LogSink sink;
+    return sink;
   }
-  const Logline& operator << (std::ostream& (*p) (std::ostream &)) const
+
+  void set_mode(Mode mode)
   {
-    for (int i = Offset; i > 0; i--)
-      std::cout << "  ";
+    this->mode = mode;
+  }
+
+  // Buffer size in bytes, 0 means every message is written out immediately.
+  void set_buffer_size(std::size_t buffer_size)
+  {
+    this->buffer_size = buffer_size;
+  }
+
+  inline bool enabled() const
+  {
+    return (this->mode == all_processes) || ((this->mode == first_process_only) && (this->process == 0));
+  }
+
+  // Starts a message - LOG style (" | " indentation, process number for top-level messages), or LOGL style (space indentation, process number always).
+  std::ostream& begin(int offset, bool line)
+  {
+    for (int i = offset; i > 0; i--)
+      this->buffer << (line ? "  " : " | ");
 #ifdef HAVE_MPI
-    std::cout << "proc. #" << Utilities::MPI::this_mpi_process(MPI_COMM_WORLD) << " | ";
+    if (line || (offset == 0))
+      this->buffer << "proc. #" << this->process << " | ";
 #endif
-    std::cout << p;
-    std::cout << std::endl;
-    return *this;
+    return this->buffer;
+  }
+
+  void end()
+  {
+    if (this->buffer.tellp() >= (std::streamoff)this->buffer_size)
+      this->flush();
+  }
+
+  void flush()
+  {
+    std::cout << this->buffer.str();
+    std::cout.flush();
+    this->buffer.str("");
   }
+
+  ~LogSink()
+  {
+    this->flush();
+  }
+
+private:
+  LogSink() : mode(all_processes), buffer_size(4096), process(Utilities::MPI::this_mpi_process(MPI_COMM_WORLD)) {}
+
+  Mode mode;
+  std::size_t buffer_size;
+  const unsigned int process;
+  std::ostringstream buffer;
 };
-#define LOG(x, ...) {std::stringstream ss; ss << __VA_ARGS__; Log<x> l; l << ss.str();}
-#define LOGL(x, ...) {std::stringstream ss; ss << __VA_ARGS__; Logline<x> l; l << ss.str();}
+
+// Messages with an offset (nesting level) above LOG_MAX_OFFSET are removed at compile time.
+#ifndef LOG_MAX_OFFSET
+#define LOG_MAX_OFFSET 100
+#endif
+// The arguments are only evaluated (formatted) if the message is written.
+#define LOG(x, ...) { if (((x) <= LOG_MAX_OFFSET) && LogSink::instance().enabled()) { LogSink::instance().begin(x, false) << __VA_ARGS__; LogSink::instance().end(); } }
+#define LOGL(x, ...) { if (((x) <= LOG_MAX_OFFSET) && LogSink::instance().enabled()) { LogSink::instance().begin(x, true) << __VA_ARGS__ << "\n"; LogSink::instance().end(); } }
+
+// Debugging output in hot loops (assembly, numerical flux, slope limiting) is compiled in only with MHDEAL_DEBUG_LOGGING
+// (defined by default in Debug builds), and then enabled at runtime by the Parameters::debug flags.
+#if defined(DEBUG) && !defined(MHDEAL_DEBUG_LOGGING)
+#define MHDEAL_DEBUG_LOGGING
+#endif
+#ifdef MHDEAL_DEBUG_LOGGING
+#define DEBUG_FLAG_SET(parameters, flag) ((parameters).debug & (parameters).flag)
+#else
+#define DEBUG_FLAG_SET(parameters, flag) false
+#endif
 
 // For debug purposes only.
 //#define OUTPUT_BASE
 
-// Safe limit on max number of basis functions (for all components !!)
-// - e.g. for linear Taylor functions in 3d, it is 4 x component count = 32 in case of MHD (8 components)
-#define BASIS_FN_COUNT 32
-
 static const double My_PI = 3.14159265358979323846;
 
 template <int dim>